@@ -0,0 +1,6 @@
+typedef struct {
+    float x;
+    float y;
+    float z;
+    float w;
+} bench4;
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <compute/core/opencl.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// generated component for host code, laid out like its OpenCL C counterpart
+struct alignas(4) bench4 {
+    alignas(4) cl_float x;
+    alignas(4) cl_float y;
+    alignas(4) cl_float z;
+    alignas(4) cl_float w;
+
+    inline static const std::vector<std::uint32_t> layout = { 16, 0, 4, 8, 12 };
+    inline static const std::string layout_probe = R"(
+typedef struct {
+    float x;
+    float y;
+    float z;
+    float w;
+} bench4;
+
+kernel void clecs_layout(__global uint* layout)
+{
+    __global bench4* probe = (__global bench4*)layout;
+    layout[0] = sizeof(bench4);
+    layout[1] = (uint)((__global uchar*)&probe->x - (__global uchar*)probe);
+    layout[2] = (uint)((__global uchar*)&probe->y - (__global uchar*)probe);
+    layout[3] = (uint)((__global uchar*)&probe->z - (__global uchar*)probe);
+    layout[4] = (uint)((__global uchar*)&probe->w - (__global uchar*)probe);
+}
+)";
+
+    template <typename archive_t>
+    void serialize(archive_t& archive)
+    {
+        archive(x);
+        archive(y);
+        archive(z);
+        archive(w);
+    }
+};
+
+static_assert(sizeof(bench4) == 16, "bench4 host size does not match its OpenCL C size");
+static_assert(offsetof(bench4, x) == 0, "bench4::x host offset does not match its OpenCL C offset");
+static_assert(offsetof(bench4, y) == 4, "bench4::y host offset does not match its OpenCL C offset");
+static_assert(offsetof(bench4, z) == 8, "bench4::z host offset does not match its OpenCL C offset");
+static_assert(offsetof(bench4, w) == 12, "bench4::w host offset does not match its OpenCL C offset");
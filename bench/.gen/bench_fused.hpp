@@ -0,0 +1,133 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#ifdef CLECS_NATIVE
+#include <compute/core/native.hpp>
+#include "bench0.hpp"
+#include "bench1.hpp"
+
+// C++ version of the kernel, executed on host threads by compute::native_registry
+#define __kernel
+#define kernel
+#define __global
+#define global
+#define __constant
+#define constant
+#define __private
+#define restrict __restrict
+
+namespace compute::native {
+namespace {
+namespace bench_fused_kernel {
+// stages only access the components of their own work-item, now held in private memory
+#define get_global_id(dim) 0
+
+
+
+
+void bench_fused_stage0(bench0* c0)
+{
+    int k = get_global_id(0);
+    c0[k].x = c0[k].x + 1.0f;
+    c0[k].y = c0[k].y + c0[k].x;
+}
+
+
+
+
+void bench_fused_stage1(bench0* c0, bench1* c1)
+{
+    int k = get_global_id(0);
+    c0[k].x = c0[k].x + c1[k].x;
+    c0[k].y = c0[k].y + c0[k].x;
+}
+
+#undef get_global_id
+
+[[maybe_unused]] kernel void smain(__global bench0* bench0_components, __global bench1* bench1_components)
+{
+    uint clecs_k = get_global_id(0);
+    bench0 clecs_bench0 = bench0_components[clecs_k];
+    bench1 clecs_bench1 = bench1_components[clecs_k];
+    bench_fused_stage0(&clecs_bench0);
+    bench_fused_stage1(&clecs_bench0, &clecs_bench1);
+    bench0_components[clecs_k] = clecs_bench0;
+    bench1_components[clecs_k] = clecs_bench1;
+}
+}
+}
+}
+
+#undef __kernel
+#undef kernel
+#undef __global
+#undef global
+#undef __constant
+#undef constant
+#undef __private
+#undef restrict
+#endif
+
+struct bench_fused {
+    inline static const std::string kernel_source = R"(
+// stages only access the components of their own work-item, now held in private memory
+#define get_global_id(dim) 0
+
+typedef struct {
+    float x;
+    float y;
+    float z;
+    float w;
+} bench0;
+
+
+void bench_fused_stage0(bench0* c0)
+{
+    int k = get_global_id(0);
+    c0[k].x = c0[k].x + 1.0f;
+    c0[k].y = c0[k].y + c0[k].x;
+}
+
+typedef struct {
+    float x;
+    float y;
+    float z;
+    float w;
+} bench1;
+
+
+void bench_fused_stage1(bench0* c0, bench1* c1)
+{
+    int k = get_global_id(0);
+    c0[k].x = c0[k].x + c1[k].x;
+    c0[k].y = c0[k].y + c0[k].x;
+}
+
+#undef get_global_id
+
+kernel void smain(__global bench0* bench0_components, __global bench1* bench1_components, uint clecs_global_count)
+{
+    if (get_global_id(0) >= clecs_global_count) {
+        return;
+    }
+    uint clecs_k = get_global_id(0);
+    bench0 clecs_bench0 = bench0_components[clecs_k];
+    bench1 clecs_bench1 = bench1_components[clecs_k];
+    bench_fused_stage0(&clecs_bench0);
+    bench_fused_stage1(&clecs_bench0, &clecs_bench1);
+    bench0_components[clecs_k] = clecs_bench0;
+    bench1_components[clecs_k] = clecs_bench1;
+}
+)";
+    static constexpr bool bounds_guard = true;
+    inline static const std::vector<bool> read_only_args = { false, false };
+#ifdef CLECS_NATIVE
+    struct native_kernel {
+        template <typename... args_t>
+        static void smain(args_t... args) { compute::native::bench_fused_kernel::smain(args...); }
+    };
+#endif
+};
+
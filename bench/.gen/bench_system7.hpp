@@ -0,0 +1,135 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#ifdef CLECS_NATIVE
+#include <compute/core/native.hpp>
+#include "bench0.hpp"
+#include "bench1.hpp"
+#include "bench2.hpp"
+#include "bench3.hpp"
+#include "bench4.hpp"
+#include "bench5.hpp"
+#include "bench6.hpp"
+
+// C++ version of the kernel, executed on host threads by compute::native_registry
+#define __kernel
+#define kernel
+#define __global
+#define global
+#define __constant
+#define constant
+#define __private
+#define restrict __restrict
+
+namespace compute::native {
+namespace {
+namespace bench_system7_kernel {
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+[[maybe_unused]] kernel void smain(__global bench0* c0, __global bench1* c1, __global bench2* c2, __global bench3* c3, __global bench4* c4, __global bench5* c5, __global bench6* c6)
+{
+    int k = get_global_id(0);
+    c0[k].x = c0[k].x + c1[k].x + c2[k].x + c3[k].x + c4[k].x + c5[k].x + c6[k].x;
+    c0[k].y = c0[k].y + c0[k].x;
+}
+}
+}
+}
+
+#undef __kernel
+#undef kernel
+#undef __global
+#undef global
+#undef __constant
+#undef constant
+#undef __private
+#undef restrict
+#endif
+
+struct bench_system7 {
+    inline static const std::string kernel_source = R"(
+typedef struct {
+    float x;
+    float y;
+    float z;
+    float w;
+} bench0;
+
+typedef struct {
+    float x;
+    float y;
+    float z;
+    float w;
+} bench1;
+
+typedef struct {
+    float x;
+    float y;
+    float z;
+    float w;
+} bench2;
+
+typedef struct {
+    float x;
+    float y;
+    float z;
+    float w;
+} bench3;
+
+typedef struct {
+    float x;
+    float y;
+    float z;
+    float w;
+} bench4;
+
+typedef struct {
+    float x;
+    float y;
+    float z;
+    float w;
+} bench5;
+
+typedef struct {
+    float x;
+    float y;
+    float z;
+    float w;
+} bench6;
+
+
+kernel void smain(__global bench0* c0, __global bench1* c1, __global bench2* c2, __global bench3* c3, __global bench4* c4, __global bench5* c5, __global bench6* c6, uint clecs_global_count)
+{
+    if (get_global_id(0) >= clecs_global_count) {
+        return;
+    }
+    int k = get_global_id(0);
+    c0[k].x = c0[k].x + c1[k].x + c2[k].x + c3[k].x + c4[k].x + c5[k].x + c6[k].x;
+    c0[k].y = c0[k].y + c0[k].x;
+}
+)";
+    static constexpr bool bounds_guard = true;
+    inline static const std::vector<bool> read_only_args = { false, false, false, false, false, false, false };
+#ifdef CLECS_NATIVE
+    struct native_kernel {
+        template <typename... args_t>
+        static void smain(args_t... args) { compute::native::bench_system7_kernel::smain(args...); }
+    };
+#endif
+};
+
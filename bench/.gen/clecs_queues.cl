@@ -0,0 +1,21 @@
+#ifndef CLECS_QUEUES
+#define CLECS_QUEUES
+
+// index of the entity processed by each work item, bound with compute::entity_ids
+#define clecs_entity_ids(var) __global const uint* var
+
+// spawn queue counter and capacity, followed by the component params of spawned entities
+#define clecs_queue_params(var) volatile __global uint* var##_count, uint var##_capacity
+#define clecs_destroy_params(var) clecs_queue_params(var), __global uint* var##_entities
+
+// reserves an element of a queue, or returns -1 once the queue is full
+int clecs_queue_reserve(volatile __global uint* count, uint capacity)
+{
+    uint k = atomic_inc(count);
+    return k < capacity ? (int)k : -1;
+}
+
+#define clecs_reserve(var) clecs_queue_reserve(var##_count, var##_capacity)
+#define clecs_destroy(var, id) do { int clecs_k = clecs_reserve(var); if (clecs_k >= 0) { var##_entities[clecs_k] = (id); } } while (0)
+
+#endif
@@ -0,0 +1,368 @@
+#include <compute/core/buffer.hpp>
+#include <compute/core/context.hpp>
+#include <compute/core/device.hpp>
+#include <compute/core/kernel.hpp>
+#include <compute/ecs/native_registry.hpp>
+#include <compute/ecs/registry.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// generated dir is in included dirs
+#include "bench0.hpp"
+#include "bench1.hpp"
+#include "bench2.hpp"
+#include "bench3.hpp"
+#include "bench4.hpp"
+#include "bench5.hpp"
+#include "bench6.hpp"
+#include "bench7.hpp"
+#include "bench_fused.hpp"
+#include "bench_system1.hpp"
+#include "bench_system2.hpp"
+#include "bench_system3.hpp"
+#include "bench_system4.hpp"
+#include "bench_system5.hpp"
+#include "bench_system6.hpp"
+#include "bench_system7.hpp"
+#include "bench_system8.hpp"
+
+struct options {
+    std::size_t device = 0;
+    std::size_t max_entities = 1000000;
+    std::size_t max_single_ops = 100000;
+    std::size_t repetitions = 10;
+    std::string format = "json";
+    std::string output;
+};
+
+struct result {
+    std::string name;
+    std::size_t entities;
+    std::size_t components;
+    std::vector<double> samples_ms;
+    double work;
+    std::string unit;
+};
+
+using bench_clock = std::chrono::steady_clock;
+
+double elapsed_ms(bench_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+}
+
+std::vector<std::size_t> get_sizes(std::size_t max_size)
+{
+    auto _sizes = std::vector<std::size_t> {};
+    for (std::size_t _size = 1000; _size <= max_size; _size *= 10) {
+        _sizes.push_back(_size);
+    }
+    return _sizes;
+}
+
+void bench_create_entity(const compute::context& ctx, const options& opts, std::vector<result>& results)
+{
+    for (auto _size : get_sizes(opts.max_entities)) {
+        auto _result = result { "create_entity", _size, 0, {}, static_cast<double>(_size), "entities/s" };
+        for (std::size_t _rep = 0; _rep < opts.repetitions; ++_rep) {
+            auto _registry = compute::registry(ctx, _size);
+            auto _start = bench_clock::now();
+            for (std::size_t _k = 0; _k < _size; ++_k) {
+                (void)_registry.create_entity();
+            }
+            _result.samples_ms.push_back(elapsed_ms(_start));
+        }
+        results.push_back(std::move(_result));
+    }
+}
+
+void bench_add_component(const compute::context& ctx, const options& opts, std::vector<result>& results)
+{
+    // the same number of components is added to a preallocated registry and to a
+    // registry starting at the smallest capacity, to measure the cost of growth
+    for (auto _size : get_sizes(opts.max_single_ops)) {
+        for (auto _capacity : { _size, std::size_t { 1000 } }) {
+            auto _result = result { "add_component/capacity=" + std::to_string(_capacity), _size, 1, {}, static_cast<double>(_size), "components/s" };
+            for (std::size_t _rep = 0; _rep < opts.repetitions; ++_rep) {
+                auto _registry = compute::registry(ctx, _capacity);
+                auto _entities = std::vector<compute::entity>(_size);
+                for (auto& _entity : _entities) {
+                    _entity = _registry.create_entity();
+                }
+                // allocating the store and checking the component layout is not measured
+                _registry.add_component<bench0>(_registry.create_entity(), bench0 {}).get();
+                auto _start = bench_clock::now();
+                auto _future = compute::future<void> {};
+                for (const auto _entity : _entities) {
+                    _future = _registry.add_component<bench0>(_entity, bench0 {});
+                }
+                _future.get();
+                _result.samples_ms.push_back(elapsed_ms(_start));
+            }
+            results.push_back(std::move(_result));
+        }
+    }
+}
+
+void bench_get_component(const compute::context& ctx, const options& opts, std::vector<result>& results)
+{
+    auto _registry = compute::registry(ctx, 1000);
+    auto _entity = _registry.create_entity();
+    _registry.add_component<bench0>(_entity, bench0 {}).get();
+    auto _result = result { "get_component", 1, 1, {}, 1, "fetches/s" };
+    for (std::size_t _rep = 0; _rep < std::max<std::size_t>(opts.repetitions, 100); ++_rep) {
+        auto _start = bench_clock::now();
+        (void)_registry.get_component<bench0>(_entity).get();
+        _result.samples_ms.push_back(elapsed_ms(_start));
+    }
+    results.push_back(std::move(_result));
+}
+
+void bench_array_buffer(const compute::context& ctx, const options& opts, std::vector<result>& results)
+{
+    for (auto _size : get_sizes(opts.max_entities)) {
+        auto _buffer = compute::array_buffer<bench0>(ctx, _size);
+        auto _values = std::vector<bench0>(_size);
+        auto _bytes = static_cast<double>(_size * sizeof(bench0));
+        auto _set = result { "array_buffer::set", _size, 1, {}, _bytes, "bytes/s" };
+        auto _fetch = result { "array_buffer::fetch", _size, 1, {}, _bytes, "bytes/s" };
+        for (std::size_t _rep = 0; _rep < opts.repetitions; ++_rep) {
+            auto _start = bench_clock::now();
+            _buffer.set(_values).get();
+            _set.samples_ms.push_back(elapsed_ms(_start));
+            _start = bench_clock::now();
+            _values = _buffer.fetch().get();
+            _fetch.samples_ms.push_back(elapsed_ms(_start));
+        }
+        results.push_back(std::move(_set));
+        results.push_back(std::move(_fetch));
+    }
+    for (auto _size : get_sizes(opts.max_entities)) {
+        auto _buffer = compute::array_buffer<bench0>(ctx, _size, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR);
+        auto _values = std::vector<bench0>(_size);
+        auto _bytes = static_cast<double>(_size * sizeof(bench0));
+        auto _fetch_into = result { "array_buffer::fetch (into)", _size, 1, {}, _bytes, "bytes/s" };
+        auto _map = result { "array_buffer::map", _size, 1, {}, _bytes, "bytes/s" };
+        for (std::size_t _rep = 0; _rep < opts.repetitions; ++_rep) {
+            auto _start = bench_clock::now();
+            _buffer.fetch(_values).get();
+            _fetch_into.samples_ms.push_back(elapsed_ms(_start));
+            _start = bench_clock::now();
+            auto _span = _buffer.map(CL_MAP_READ).get();
+            std::copy(_span.begin(), _span.end(), _values.begin());
+            _span.unmap().get();
+            _map.samples_ms.push_back(elapsed_ms(_start));
+        }
+        results.push_back(std::move(_fetch_into));
+        results.push_back(std::move(_map));
+    }
+}
+
+void bench_kernel_build(const compute::context& ctx, const options& opts, std::vector<result>& results)
+{
+    auto _result = result { "kernel::build", 0, 8, {}, 1, "builds/s" };
+    for (std::size_t _rep = 0; _rep < opts.repetitions; ++_rep) {
+        // a distinct define per build defeats driver-side program caching
+        auto _options = "-D CLECS_BENCH_REP=" + std::to_string(_rep);
+        auto _start = bench_clock::now();
+        auto _krn = compute::kernel(ctx, bench_system8::kernel_source, "smain", _options);
+        _result.samples_ms.push_back(elapsed_ms(_start));
+    }
+    results.push_back(std::move(_result));
+}
+
+template <typename system_t, typename... components_t>
+void bench_execute_system(const compute::context& ctx, const options& opts, std::vector<result>& results)
+{
+    for (auto _size : get_sizes(opts.max_entities)) {
+        auto _registry = compute::registry(ctx, _size);
+        auto _entities = std::vector<compute::entity>(_size);
+        for (auto& _entity : _entities) {
+            _entity = _registry.create_entity();
+        }
+        (_registry.add_components<components_t>(_entities, std::vector<components_t>(_size)).get(), ...);
+        _registry.compile_system<system_t>();
+        _registry.execute_system<system_t, components_t...>().get();
+        auto _result = result { "execute_system", _size, sizeof...(components_t), {}, static_cast<double>(_size), "entities/s" };
+        for (std::size_t _rep = 0; _rep < opts.repetitions; ++_rep) {
+            auto _start = bench_clock::now();
+            _registry.execute_system<system_t, components_t...>().get();
+            _result.samples_ms.push_back(elapsed_ms(_start));
+        }
+        results.push_back(std::move(_result));
+    }
+}
+
+template <typename system_t, typename... components_t>
+void bench_execute_system_native(const options& opts, std::vector<result>& results)
+{
+    // same workload as bench_execute_system, run as native C++ on host threads
+    for (auto _size : get_sizes(opts.max_entities)) {
+        auto _registry = compute::native_registry(0, _size);
+        auto _entities = std::vector<compute::entity>(_size);
+        for (auto& _entity : _entities) {
+            _entity = _registry.create_entity();
+        }
+        (_registry.add_components<components_t>(_entities, std::vector<components_t>(_size)).get(), ...);
+        _registry.execute_system<system_t, components_t...>().get();
+        auto _result = result { "execute_system (native)", _size, sizeof...(components_t), {}, static_cast<double>(_size), "entities/s" };
+        for (std::size_t _rep = 0; _rep < opts.repetitions; ++_rep) {
+            auto _start = bench_clock::now();
+            _registry.execute_system<system_t, components_t...>().get();
+            _result.samples_ms.push_back(elapsed_ms(_start));
+        }
+        results.push_back(std::move(_result));
+    }
+}
+
+void bench_step(const compute::context& ctx, const options& opts, const std::string& name, const compute::pipeline& pl, std::vector<result>& results)
+{
+    constexpr auto _steps = std::size_t { 100 };
+    for (auto _size : get_sizes(opts.max_entities)) {
+        auto _registry = compute::registry(ctx, _size);
+        auto _entities = std::vector<compute::entity>(_size);
+        for (auto& _entity : _entities) {
+            _entity = _registry.create_entity();
+        }
+        _registry.add_components<bench0>(_entities, std::vector<bench0>(_size)).get();
+        _registry.add_components<bench1>(_entities, std::vector<bench1>(_size)).get();
+        _registry.step(1, pl).get();
+        auto _result = result { name + "/" + std::to_string(_steps), _size, 2, {}, static_cast<double>(_size * _steps), "entities/s" };
+        for (std::size_t _rep = 0; _rep < opts.repetitions; ++_rep) {
+            auto _start = bench_clock::now();
+            _registry.step(_steps, pl).get();
+            _result.samples_ms.push_back(elapsed_ms(_start));
+        }
+        results.push_back(std::move(_result));
+    }
+}
+
+double get_mean(const std::vector<double>& samples)
+{
+    auto _mean = 0.0;
+    for (const auto _sample : samples) {
+        _mean += _sample / static_cast<double>(samples.size());
+    }
+    return _mean;
+}
+
+void write_json(std::ostream& os, const std::string& device_name, const std::vector<result>& results)
+{
+    os << "{\n  \"device\": \"" << device_name << "\",\n  \"results\": [";
+    for (std::size_t _k = 0; _k < results.size(); ++_k) {
+        auto _samples = results[_k].samples_ms;
+        std::sort(_samples.begin(), _samples.end());
+        auto _mean = get_mean(_samples);
+        os << (_k ? ",\n" : "\n");
+        os << "    { \"name\": \"" << results[_k].name << "\", \"entities\": " << results[_k].entities;
+        os << ", \"components\": " << results[_k].components << ", \"repetitions\": " << _samples.size();
+        os << ", \"min_ms\": " << _samples.front() << ", \"mean_ms\": " << _mean << ", \"max_ms\": " << _samples.back();
+        os << ", \"throughput\": " << results[_k].work / (_samples.front() * 1e-3) << ", \"unit\": \"" << results[_k].unit << "\" }";
+    }
+    os << "\n  ]\n}\n";
+}
+
+void write_csv(std::ostream& os, const std::string& device_name, const std::vector<result>& results)
+{
+    os << "device,name,entities,components,repetitions,min_ms,mean_ms,max_ms,throughput,unit\n";
+    for (const auto& _result : results) {
+        auto _samples = _result.samples_ms;
+        std::sort(_samples.begin(), _samples.end());
+        auto _mean = get_mean(_samples);
+        os << "\"" << device_name << "\"," << _result.name << "," << _result.entities << "," << _result.components << ",";
+        os << _samples.size() << "," << _samples.front() << "," << _mean << "," << _samples.back() << ",";
+        os << _result.work / (_samples.front() * 1e-3) << "," << _result.unit << "\n";
+    }
+}
+
+options parse_options(int argc, char* argv[])
+{
+    auto _opts = options {};
+    for (int _k = 1; _k + 1 < argc; _k += 2) {
+        auto _key = std::string(argv[_k]);
+        auto _value = std::string(argv[_k + 1]);
+        if (_key == "--device") {
+            _opts.device = std::stoul(_value);
+        } else if (_key == "--max-entities") {
+            _opts.max_entities = std::stoul(_value);
+        } else if (_key == "--max-single-ops") {
+            _opts.max_single_ops = std::stoul(_value);
+        } else if (_key == "--repetitions") {
+            _opts.repetitions = std::max<std::size_t>(std::stoul(_value), 1);
+        } else if (_key == "--format" && (_value == "json" || _value == "csv")) {
+            _opts.format = _value;
+        } else if (_key == "--output") {
+            _opts.output = _value;
+        } else {
+            throw std::invalid_argument("Unknown option: " + _key + " " + _value);
+        }
+    }
+    return _opts;
+}
+
+int main(int argc, char* argv[])
+{
+    auto _opts = options {};
+    try {
+        _opts = parse_options(argc, argv);
+    } catch (const std::exception& ex) {
+        std::cout << ex.what() << "\n";
+        std::cout << "Usage: " << argv[0] << " [--device idx] [--max-entities n] [--max-single-ops n] [--repetitions n] [--format json|csv] [--output path]\n";
+        return 1;
+    }
+    auto _dev = compute::device::get_device(_opts.device);
+    auto _ctx = compute::context(_dev);
+    std::cerr << "device name : " << _dev.get_name() << std::endl;
+
+    auto _results = std::vector<result> {};
+    bench_create_entity(_ctx, _opts, _results);
+    bench_add_component(_ctx, _opts, _results);
+    bench_get_component(_ctx, _opts, _results);
+    bench_array_buffer(_ctx, _opts, _results);
+    bench_kernel_build(_ctx, _opts, _results);
+    bench_execute_system<bench_system1, bench0>(_ctx, _opts, _results);
+    bench_execute_system<bench_system2, bench0, bench1>(_ctx, _opts, _results);
+    bench_execute_system<bench_system3, bench0, bench1, bench2>(_ctx, _opts, _results);
+    bench_execute_system<bench_system4, bench0, bench1, bench2, bench3>(_ctx, _opts, _results);
+    bench_execute_system<bench_system5, bench0, bench1, bench2, bench3, bench4>(_ctx, _opts, _results);
+    bench_execute_system<bench_system6, bench0, bench1, bench2, bench3, bench4, bench5>(_ctx, _opts, _results);
+    bench_execute_system<bench_system7, bench0, bench1, bench2, bench3, bench4, bench5, bench6>(_ctx, _opts, _results);
+    bench_execute_system<bench_system8, bench0, bench1, bench2, bench3, bench4, bench5, bench6, bench7>(_ctx, _opts, _results);
+    bench_execute_system_native<bench_system1, bench0>(_opts, _results);
+    bench_execute_system_native<bench_system2, bench0, bench1>(_opts, _results);
+    bench_execute_system_native<bench_system3, bench0, bench1, bench2>(_opts, _results);
+    bench_execute_system_native<bench_system4, bench0, bench1, bench2, bench3>(_opts, _results);
+    bench_execute_system_native<bench_system5, bench0, bench1, bench2, bench3, bench4>(_opts, _results);
+    bench_execute_system_native<bench_system6, bench0, bench1, bench2, bench3, bench4, bench5>(_opts, _results);
+    bench_execute_system_native<bench_system7, bench0, bench1, bench2, bench3, bench4, bench5, bench6>(_opts, _results);
+    bench_execute_system_native<bench_system8, bench0, bench1, bench2, bench3, bench4, bench5, bench6, bench7>(_opts, _results);
+    // the fused system runs both stages in a single kernel, reading and writing components once,
+    // on the same entities since bench_step gives every entity both components
+    auto _pipeline = compute::pipeline {};
+    _pipeline.add<bench_system1, bench0>().add<bench_system2, bench0, bench1>();
+    auto _fused_pipeline = compute::pipeline {};
+    _fused_pipeline.add<bench_fused, bench0, bench1>();
+    bench_step(_ctx, _opts, "step", _pipeline, _results);
+    bench_step(_ctx, _opts, "step (fused)", _fused_pipeline, _results);
+
+    auto _ofs = std::ofstream {};
+    if (!_opts.output.empty()) {
+        _ofs.open(_opts.output);
+        if (!_ofs.is_open()) {
+            std::cout << "Failed to open output file: " << _opts.output << "\n";
+            return 1;
+        }
+    }
+    auto& _os = _opts.output.empty() ? std::cout : static_cast<std::ostream&>(_ofs);
+    if (_opts.format == "csv") {
+        write_csv(_os, _dev.get_name(), _results);
+    } else {
+        write_json(_os, _dev.get_name(), _results);
+    }
+    return 0;
+}
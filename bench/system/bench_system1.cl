@@ -0,0 +1,8 @@
+#include "bench0.cl"
+
+kernel void smain(__global bench0* c0)
+{
+    int k = get_global_id(0);
+    c0[k].x = c0[k].x + 1.0f;
+    c0[k].y = c0[k].y + c0[k].x;
+}
@@ -0,0 +1,9 @@
+#include "bench0.cl"
+#include "bench1.cl"
+
+kernel void smain(__global bench0* c0, __global bench1* c1)
+{
+    int k = get_global_id(0);
+    c0[k].x = c0[k].x + c1[k].x;
+    c0[k].y = c0[k].y + c0[k].x;
+}
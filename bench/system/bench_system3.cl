@@ -0,0 +1,10 @@
+#include "bench0.cl"
+#include "bench1.cl"
+#include "bench2.cl"
+
+kernel void smain(__global bench0* c0, __global bench1* c1, __global bench2* c2)
+{
+    int k = get_global_id(0);
+    c0[k].x = c0[k].x + c1[k].x + c2[k].x;
+    c0[k].y = c0[k].y + c0[k].x;
+}
@@ -0,0 +1,12 @@
+#include "bench0.cl"
+#include "bench1.cl"
+#include "bench2.cl"
+#include "bench3.cl"
+#include "bench4.cl"
+
+kernel void smain(__global bench0* c0, __global bench1* c1, __global bench2* c2, __global bench3* c3, __global bench4* c4)
+{
+    int k = get_global_id(0);
+    c0[k].x = c0[k].x + c1[k].x + c2[k].x + c3[k].x + c4[k].x;
+    c0[k].y = c0[k].y + c0[k].x;
+}
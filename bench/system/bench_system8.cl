@@ -0,0 +1,15 @@
+#include "bench0.cl"
+#include "bench1.cl"
+#include "bench2.cl"
+#include "bench3.cl"
+#include "bench4.cl"
+#include "bench5.cl"
+#include "bench6.cl"
+#include "bench7.cl"
+
+kernel void smain(__global bench0* c0, __global bench1* c1, __global bench2* c2, __global bench3* c3, __global bench4* c4, __global bench5* c5, __global bench6* c6, __global bench7* c7)
+{
+    int k = get_global_id(0);
+    c0[k].x = c0[k].x + c1[k].x + c2[k].x + c3[k].x + c4[k].x + c5[k].x + c6[k].x + c7[k].x;
+    c0[k].y = c0[k].y + c0[k].x;
+}
@@ -33,7 +33,7 @@ function(target_link_systems target systems_dir gen_dir)
     endif()
     set(STAMP_FILE ${gen_dir}/systemc.stamp)
 
-    file(GLOB SYSTEM_FILES "${systems_dir}/*.cl")
+    file(GLOB SYSTEM_FILES "${systems_dir}/*.cl" "${systems_dir}/*.json")
 
     add_custom_command(
         OUTPUT ${STAMP_FILE}
@@ -1,38 +1,178 @@
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <regex>
 #include <sstream>
+#include <string>
+#include <vector>
 
 #include <rapidjson/document.h>
 #include <rapidjson/istreamwrapper.h>
 
-std::string generate_host_code(const std::string& name, const rapidjson::Value& fields)
+struct field_type {
+    std::string device;
+    std::string host;
+    std::size_t size;
+    std::size_t alignment;
+};
+
+struct field_layout {
+    std::string name;
+    field_type type;
+    std::size_t offset;
+    std::size_t padding;
+};
+
+struct component_layout {
+    std::vector<field_layout> fields;
+    std::size_t size;
+    std::size_t alignment;
+    std::size_t padding;
+};
+
+// sizes and alignments of OpenCL C built-in types, where 3-component vectors
+// are stored like 4-component ones
+field_type get_field_type(const std::string& type)
+{
+    static const auto _scalars = std::map<std::string, std::size_t> {
+        { "char", 1 }, { "uchar", 1 }, { "short", 2 }, { "ushort", 2 }, { "int", 4 }, { "uint", 4 },
+        { "long", 8 }, { "ulong", 8 }, { "float", 4 }, { "double", 8 }
+    };
+    auto _match = std::smatch {};
+    if (!std::regex_match(type, _match, std::regex(R"(([a-z]+?)(2|3|4|8|16)?)")) || _scalars.count(_match[1]) == 0) {
+        throw std::runtime_error("Unsupported field type: " + type);
+    }
+    auto _width = _match[2].matched ? std::stoul(_match[2]) : 1;
+    auto _size = _scalars.at(_match[1]) * (_width == 3 ? 4 : _width);
+    return field_type { type, "cl_" + type, _size, _size };
+}
+
+component_layout compute_layout(const rapidjson::Value& fields)
+{
+    auto _layout = component_layout { {}, 0, 1, 0 };
+    for (auto _it = fields.MemberBegin(); _it != fields.MemberEnd(); ++_it) {
+        auto _type = get_field_type(_it->value.GetString());
+        auto _offset = (_layout.size + _type.alignment - 1) / _type.alignment * _type.alignment;
+        if (!_layout.fields.empty()) {
+            _layout.fields.back().padding = _offset - _layout.size;
+        }
+        _layout.fields.push_back(field_layout { _it->name.GetString(), _type, _offset, 0 });
+        _layout.size = _offset + _type.size;
+        _layout.alignment = std::max(_layout.alignment, _type.alignment);
+    }
+    auto _size = (_layout.size + _layout.alignment - 1) / _layout.alignment * _layout.alignment;
+    _layout.padding = _size - _layout.size;
+    _layout.size = _size;
+    return _layout;
+}
+
+std::string generate_device_struct(const std::string& name, const component_layout& layout)
+{
+    // padding is explicit so that the offsets never depend on the OpenCL compiler
+    auto _oss = std::ostringstream {};
+    auto _pad_idx = 0;
+    _oss << "typedef struct {\n";
+    for (const auto& _field : layout.fields) {
+        _oss << "    " << _field.type.device << " " << _field.name << ";\n";
+        if (_field.padding) {
+            _oss << "    uchar _pad" << _pad_idx++ << "[" << _field.padding << "];\n";
+        }
+    }
+    if (layout.padding) {
+        _oss << "    uchar _pad" << _pad_idx++ << "[" << layout.padding << "];\n";
+    }
+    _oss << "} " << name << ";\n";
+    return _oss.str();
+}
+
+std::string generate_host_code(const std::string& name, const component_layout& layout, bool soa)
 {
     auto _oss = std::ostringstream {};
+    auto _pad_idx = 0;
     _oss << "#pragma once\n\n";
-    _oss << "// generated component for host code\n";
-    _oss << "struct " << name << " {\n";
-    for (auto _it = fields.MemberBegin(); _it != fields.MemberEnd(); ++_it) {
-        _oss << "    " << _it->value.GetString() << " " << _it->name.GetString() << ";\n";
+    _oss << "#include <compute/core/opencl.hpp>\n\n";
+    _oss << "#include <cstddef>\n";
+    _oss << "#include <cstdint>\n";
+    _oss << "#include <string>\n";
+    if (soa) {
+        _oss << "#include <tuple>\n";
+    }
+    _oss << "#include <vector>\n\n";
+    _oss << "// generated component for host code, laid out like its OpenCL C counterpart\n";
+    _oss << "struct alignas(" << layout.alignment << ") " << name << " {\n";
+    for (const auto& _field : layout.fields) {
+        _oss << "    " << (_field.type.alignment > 1 ? "alignas(" + std::to_string(_field.type.alignment) + ") " : "") << _field.type.host << " " << _field.name << ";\n";
+        if (_field.padding) {
+            _oss << "    cl_uchar _pad" << _pad_idx++ << "[" << _field.padding << "];\n";
+        }
+    }
+    if (layout.padding) {
+        _oss << "    cl_uchar _pad" << _pad_idx++ << "[" << layout.padding << "];\n";
+    }
+    if (soa) {
+        // the registry stores one device buffer per entry of field_types
+        auto _types = std::ostringstream {};
+        auto _names = std::ostringstream {};
+        for (const auto& _field : layout.fields) {
+            _types << (&_field == &layout.fields.front() ? "" : ", ") << _field.type.host;
+            _names << (&_field == &layout.fields.front() ? "" : ", ") << _field.name;
+        }
+        _oss << "\n    using field_types = std::tuple<" << _types.str() << ">;\n";
+        _oss << "    auto as_tuple() { return std::tie(" << _names.str() << "); }\n";
+        _oss << "    auto as_tuple() const { return std::tie(" << _names.str() << "); }\n";
     }
+
+    // size then field offsets, as computed here and as measured on the device by layout_probe
+    auto _offsets = std::ostringstream {};
+    auto _probe = std::ostringstream {};
+    _offsets << layout.size;
+    for (const auto& _field : layout.fields) {
+        _offsets << ", " << _field.offset;
+        _probe << "    layout[" << (&_field - &layout.fields.front() + 1) << "] = (uint)((__global uchar*)&probe->" << _field.name << " - (__global uchar*)probe);\n";
+    }
+    _oss << "\n    inline static const std::vector<std::uint32_t> layout = { " << _offsets.str() << " };\n";
+    _oss << "    inline static const std::string layout_probe = R\"(\n";
+    _oss << generate_device_struct(name, layout);
+    _oss << "\nkernel void clecs_layout(__global uint* layout)\n{\n";
+    _oss << "    __global " << name << "* probe = (__global " << name << "*)layout;\n";
+    _oss << "    layout[0] = sizeof(" << name << ");\n";
+    _oss << _probe.str() << "}\n)\";\n";
+
     _oss << "\n    template <typename archive_t>\n";
     _oss << "    void serialize(archive_t& archive)\n";
     _oss << "    {\n";
-    for (auto itr = fields.MemberBegin(); itr != fields.MemberEnd(); ++itr) {
-        _oss << "        archive(" << itr->name.GetString() << ");\n";
+    for (const auto& _field : layout.fields) {
+        _oss << "        archive(" << _field.name << ");\n";
+    }
+    _oss << "    }\n};\n\n";
+    _oss << "static_assert(sizeof(" << name << ") == " << layout.size << ", \"" << name << " host size does not match its OpenCL C size\");\n";
+    for (const auto& _field : layout.fields) {
+        _oss << "static_assert(offsetof(" << name << ", " << _field.name << ") == " << _field.offset << ", \"" << name << "::" << _field.name << " host offset does not match its OpenCL C offset\");\n";
     }
-    _oss << "    }\n};\n";
     return _oss.str();
 }
 
-std::string generate_device_code(const std::string& name, const rapidjson::Value& fields)
+std::string generate_device_code(const std::string& name, const component_layout& layout, bool soa)
 {
     auto _oss = std::ostringstream {};
-    _oss << "typedef struct {\n";
-    for (auto _it = fields.MemberBegin(); _it != fields.MemberEnd(); ++_it) {
-        _oss << "    " << _it->value.GetString() << " " << _it->name.GetString() << ";\n";
+    _oss << generate_device_struct(name, layout);
+    if (soa) {
+        // systems receive one pointer per field, named <var>_<field>
+        auto _params = std::ostringstream {};
+        auto _load = std::ostringstream {};
+        auto _store = std::ostringstream {};
+        for (const auto& _field : layout.fields) {
+            auto _first = &_field == &layout.fields.front();
+            _params << (_first ? "" : ", ") << "__global " << _field.type.device << "* var##_" << _field.name;
+            _load << (_first ? "" : ", ") << "." << _field.name << " = var##_" << _field.name << "[k]";
+            _store << " var##_" << _field.name << "[k] = (val)." << _field.name << ";";
+        }
+        _oss << "\n#define " << name << "_params(var) " << _params.str() << "\n";
+        _oss << "#define " << name << "_load(var, k) ((" << name << ") { " << _load.str() << " })\n";
+        _oss << "#define " << name << "_store(var, k, val) do {" << _store.str() << " } while (0)\n";
     }
-    _oss << "} " << name << ";\n";
     return _oss.str();
 }
 
@@ -50,8 +190,13 @@ void process_file(const std::filesystem::path& input_path, const std::filesystem
     }
     auto _name = _doc["name"].GetString();
     const auto& _fields = _doc["fields"];
-    auto _host_code = generate_host_code(_name, _fields);
-    auto _device_code = generate_device_code(_name, _fields);
+    auto _layout = std::string(_doc.HasMember("layout") ? _doc["layout"].GetString() : "aos");
+    if (_layout != "aos" && _layout != "soa") {
+        throw std::runtime_error("Invalid component layout '" + _layout + "' in: " + input_path.string());
+    }
+    auto _component_layout = compute_layout(_fields);
+    auto _host_code = generate_host_code(_name, _component_layout, _layout == "soa");
+    auto _device_code = generate_device_code(_name, _component_layout, _layout == "soa");
     std::filesystem::create_directories(out_host_dir);
     std::filesystem::create_directories(out_device_dir);
     auto _output_path = std::filesystem::path(out_host_dir / (std::string(_name) + ".hpp"));
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -5,6 +6,17 @@
 #include <sstream>
 #include <string>
 #include <unordered_set>
+#include <vector>
+
+#include <rapidjson/document.h>
+#include <rapidjson/istreamwrapper.h>
+
+struct kernel_location {
+    std::size_t begin;
+    std::size_t params_begin;
+    std::size_t params_end;
+    std::size_t body;
+};
 
 std::string load_file(const std::filesystem::path& path)
 {
@@ -40,25 +52,364 @@ std::string resolve_includes(const std::string& source, const std::filesystem::p
     return _resolved.str();
 }
 
-void generate_kernel_struct(const std::string& kernel_name, const std::string& resolved_code, const std::filesystem::path& output_path)
+std::string strip_comments(const std::string& code)
+{
+    return std::regex_replace(code, std::regex(R"(//[^\n]*|/\*[^*]*\*+([^/*][^*]*\*+)*/)"), " ");
+}
+
+std::vector<std::string> get_kernel_params(const std::string& resolved_code)
+{
+    auto _code = strip_comments(resolved_code);
+    auto _match = std::smatch {};
+    if (!std::regex_search(_code, _match, std::regex(R"(\b(__)?kernel\s+void\s+smain\s*\()"))) {
+        throw std::runtime_error("Kernel smain not found");
+    }
+    auto _params = std::vector<std::string> {};
+    auto _param = std::string {};
+    auto _depth = 1;
+    for (auto _it = _code.cbegin() + _match.position(0) + _match.length(0); _it != _code.cend(); ++_it) {
+        if (*_it == '(') {
+            ++_depth;
+        } else if (*_it == ')' && --_depth == 0) {
+            break;
+        } else if (*_it == ',' && _depth == 1) {
+            _params.push_back(_param);
+            _param.clear();
+            continue;
+        }
+        _param += *_it;
+    }
+    if (_param.find_first_not_of(" \t\r\n") != std::string::npos && !std::regex_match(_param, std::regex(R"(\s*void\s*)"))) {
+        _params.push_back(_param);
+    }
+    return _params;
+}
+
+bool is_read_only_param(const std::string& param)
+{
+    // macro parameters such as soa component params expand to several arguments
+    if (param.find('(') != std::string::npos) {
+        return false;
+    }
+    auto _pointer = param.find('*');
+    if (_pointer == std::string::npos) {
+        return false;
+    }
+    auto _qualifiers = param.substr(0, _pointer);
+    return std::regex_search(_qualifiers, std::regex(R"(\b(const|__constant|constant)\b)"));
+}
+
+kernel_location find_kernel(const std::string& resolved_code)
+{
+    auto _match = std::smatch {};
+    if (!std::regex_search(resolved_code, _match, std::regex(R"(\b(__)?kernel\s+void\s+smain\s*\()"))) {
+        throw std::runtime_error("Kernel smain not found");
+    }
+    auto _location = kernel_location {};
+    _location.begin = static_cast<std::size_t>(_match.position(0));
+    _location.params_begin = static_cast<std::size_t>(_match.position(0) + _match.length(0));
+    _location.params_end = _location.params_begin;
+    for (auto _depth = 1; _location.params_end < resolved_code.size(); ++_location.params_end) {
+        if (resolved_code[_location.params_end] == '(') {
+            ++_depth;
+        } else if (resolved_code[_location.params_end] == ')' && --_depth == 0) {
+            break;
+        }
+    }
+    _location.body = resolved_code.find('{', _location.params_end);
+    if (_location.params_end == resolved_code.size() || _location.body == std::string::npos) {
+        throw std::runtime_error("Kernel smain has no body");
+    }
+    return _location;
+}
+
+std::string add_bounds_guard(const std::string& resolved_code)
+{
+    // global sizes are padded to a multiple of the work-group size, so work-items past the count return early
+    auto _location = find_kernel(resolved_code);
+    auto _params = resolved_code.substr(_location.params_begin, _location.params_end - _location.params_begin);
+    auto _empty = std::regex_match(_params, std::regex(R"(\s*(void)?\s*)"));
+    auto _guarded = resolved_code.substr(0, _location.params_begin);
+    _guarded += _empty ? std::string("uint clecs_global_count") : _params + ", uint clecs_global_count";
+    _guarded += resolved_code.substr(_location.params_end, _location.body + 1 - _location.params_end);
+    _guarded += "\n    if (get_global_id(0) >= clecs_global_count) {\n        return;\n    }";
+    _guarded += resolved_code.substr(_location.body + 1);
+    return _guarded;
+}
+
+bool accepts_bounds_guard(const std::string& resolved_code)
+{
+    // work-items returning early would skip the barriers of their work-group, and padding changes the global size
+    return !std::regex_search(strip_comments(resolved_code), std::regex(R"(\b(barrier|work_group_barrier|get_global_size|get_num_groups)\b)"));
+}
+
+std::string join_params(const std::vector<std::string>& params)
+{
+    auto _oss = std::ostringstream {};
+    for (std::size_t _k = 0; _k < params.size(); ++_k) {
+        _oss << (_k ? ", " : "") << params[_k];
+    }
+    return _oss.str();
+}
+
+void check_element_wise(const std::string& system, const std::string& resolved_code, const std::vector<std::string>& components)
+{
+    // stages run on the components of their own work-item only, so the global id may only index
+    // component parameters, directly or through variables initialized with it and never modified
+    auto _code = strip_comments(resolved_code);
+    auto _reject = [&](const std::string& access) {
+        throw std::runtime_error("System " + system + " has a work-item access that cannot be fused: " + access);
+    };
+    auto _match = std::smatch {};
+    if (std::regex_search(_code, _match, std::regex(R"(\b(get_global_size|get_global_offset|get_local_id|get_local_size|get_group_id|get_num_groups|get_work_dim|barrier|mem_fence|read_mem_fence|write_mem_fence)\b)"))) {
+        _reject(_match[0].str());
+    }
+    auto _body_begin = find_kernel(_code).body;
+    auto _body = _code.substr(_body_begin);
+    auto _indices = std::vector<std::string> { R"(get_global_id\s*\(\s*0\s*\))" };
+    auto _declaration = std::regex(R"(\b(?:const\s+)?(?:int|uint|unsigned\s+int|size_t)\s+(\w+)\s*=\s*get_global_id\s*\(\s*0\s*\)\s*;)");
+    for (auto _it = std::sregex_iterator(_body.cbegin(), _body.cend(), _declaration); _it != std::sregex_iterator(); ++_it) {
+        _indices.push_back((*_it)[1].str());
+    }
+    _body = std::regex_replace(_body, _declaration, " ");
+    for (const auto& _component : components) {
+        for (const auto& _index : _indices) {
+            _body = std::regex_replace(_body, std::regex(R"(\b)" + _component + R"(\s*\[\s*)" + _index + R"(\s*\])"), " ");
+        }
+        if (std::regex_search(_body, _match, std::regex(R"(\b)" + _component + R"(\b)"))) {
+            _reject(_match[0].str());
+        }
+    }
+    for (std::size_t _k = 1; _k < _indices.size(); ++_k) {
+        if (std::regex_search(_body, _match, std::regex(R"(\b)" + _indices[_k] + R"(\b)"))) {
+            _reject(_match[0].str());
+        }
+    }
+    auto _remaining = _code.substr(0, _body_begin) + _body;
+    if (std::regex_search(_remaining, _match, std::regex(R"(\bget_global_id\b)"))) {
+        _reject(_match[0].str());
+    }
+}
+
+std::string generate_fused_code(const std::string& fused_name, const std::vector<std::string>& systems, const std::filesystem::path& input_dir, const std::filesystem::path& include_base)
+{
+    // every stage runs on private copies of the components of its work-item, which the fused
+    // kernel loads once before the first stage and stores once after the last one
+    struct fused_component {
+        std::string type;
+        bool read_only;
+    };
+    auto _visited = std::unordered_set<std::string> {};
+    auto _stages = std::ostringstream {};
+    auto _calls = std::ostringstream {};
+    auto _components = std::vector<fused_component> {};
+    auto _uniforms = std::vector<std::string> {};
+    auto _stage_types = std::vector<std::unordered_set<std::string>>(systems.size());
+    auto _declared = std::string {};
+    auto _name_pattern = std::regex(R"((\w+)\s*(\[[^\]]*\])?\s*$)");
+    auto _qualifier_pattern = std::regex(R"(\b(__global|global|const|restrict|__restrict|volatile)\b|\*)");
+    for (std::size_t _k = 0; _k < systems.size(); ++_k) {
+        auto _resolved = resolve_includes(load_file(input_dir / (systems[_k] + ".cl")), include_base, _visited);
+        auto _location = find_kernel(_resolved);
+        _declared += _resolved.substr(0, _location.begin);
+        auto _stage_name = fused_name + "_stage" + std::to_string(_k);
+        auto _stage_params = std::vector<std::string> {};
+        auto _arguments = std::vector<std::string> {};
+        auto _stage_components = std::vector<std::string> {};
+        for (auto _param : get_kernel_params(_resolved)) {
+            _param = std::regex_replace(_param, std::regex(R"(^\s+|\s+$)"), "");
+            auto _match = std::smatch {};
+            if (_param.find('(') != std::string::npos || !std::regex_search(_param, _match, _name_pattern)) {
+                throw std::runtime_error("System " + systems[_k] + " has a parameter that cannot be fused: " + _param);
+            }
+            auto _name = _match[1].str();
+            if (_param.find('*') == std::string::npos) {
+                // uniforms of every stage are passed separately, prefixed by the stage name
+                _uniforms.push_back(std::regex_replace(_param, _name_pattern, _stage_name + "_" + _name + "$2"));
+                _stage_params.push_back(_param);
+                _arguments.push_back(_stage_name + "_" + _name);
+                continue;
+            }
+            auto _type = std::regex_replace(_param.substr(0, static_cast<std::size_t>(_match.position(0))), _qualifier_pattern, " ");
+            _type = std::regex_replace(_type, std::regex(R"(^\s+|\s+$)"), "");
+            auto _global = std::regex_search(_param, std::regex(R"(\b(__global|global)\b)"));
+            auto _component = std::regex_search(_declared, std::regex(R"(typedef\s+struct\s*\{[^}]*\}\s*)" + _type + R"(\s*;)"));
+            if (!_global || !_component || std::count(_param.begin(), _param.end(), '*') != 1) {
+                throw std::runtime_error("System " + systems[_k] + " has a parameter that cannot be fused: " + _param);
+            }
+            auto _it = std::find_if(_components.begin(), _components.end(), [&](const fused_component& component) { return component.type == _type; });
+            if (_it == _components.end()) {
+                _it = _components.insert(_components.end(), fused_component { _type, true });
+            }
+            _it->read_only = _it->read_only && is_read_only_param(_param);
+            _stage_types[_k].insert(_type);
+            _stage_params.push_back(std::regex_replace(_param, std::regex(R"(\b(__global|global)\b\s*)"), ""));
+            _arguments.push_back("&clecs_" + _type);
+            _stage_components.push_back(_name);
+        }
+        check_element_wise(systems[_k], _resolved, _stage_components);
+        _stages << _resolved.substr(0, _location.begin);
+        _stages << "void " << _stage_name << "(" << join_params(_stage_params) << ")\n";
+        _stages << _resolved.substr(_location.body) << "\n";
+        _calls << "    " << _stage_name << "(" << join_params(_arguments) << ");\n";
+    }
+    for (std::size_t _k = 0; _k < systems.size(); ++_k) {
+        if (_stage_types[_k].size() != _components.size()) {
+            std::cout << "Warning: " << fused_name << " skips the entities " << systems[_k] << " runs on without the components of the other stages\n";
+        }
+    }
+    auto _params = std::vector<std::string> {};
+    for (const auto& _component : _components) {
+        _params.push_back(std::string("__global ") + (_component.read_only ? "const " : "") + _component.type + "* " + _component.type + "_components");
+    }
+    _params.insert(_params.end(), _uniforms.begin(), _uniforms.end());
+    auto _oss = std::ostringstream {};
+    _oss << "// fused from " << join_params(systems) << "\n";
+    _oss << "// runs on the entities holding every component of every stage, which may be fewer than a stage alone runs on\n";
+    _oss << "// stages only access the components of their own work-item, now held in private memory\n";
+    _oss << "#define get_global_id(dim) 0\n\n";
+    _oss << _stages.str();
+    _oss << "#undef get_global_id\n\n";
+    _oss << "kernel void smain(" << join_params(_params) << ")\n{\n";
+    _oss << "    uint clecs_k = get_global_id(0);\n";
+    for (const auto& _component : _components) {
+        _oss << "    " << _component.type << " clecs_" << _component.type << " = " << _component.type << "_components[clecs_k];\n";
+    }
+    _oss << _calls.str();
+    for (const auto& _component : _components) {
+        if (!_component.read_only) {
+            _oss << "    " << _component.type << "_components[clecs_k] = clecs_" << _component.type << ";\n";
+        }
+    }
+    _oss << "}\n";
+    return _oss.str();
+}
+
+std::string generate_native_code(const std::string& kernel_name, const std::string& resolved_code, const std::filesystem::path& include_base)
+{
+    // structs of generated components are replaced by their host counterparts, which have the same layout
+    auto _includes = std::ostringstream {};
+    auto _code = std::string {};
+    auto _struct_pattern = std::regex(R"(typedef\s+struct\s*\{[^}]*\}\s*(\w+)\s*;)");
+    auto _last = resolved_code.cbegin();
+    for (auto _it = std::sregex_iterator(resolved_code.cbegin(), resolved_code.cend(), _struct_pattern); _it != std::sregex_iterator(); ++_it) {
+        auto _name = (*_it)[1].str();
+        if (std::filesystem::exists(include_base / (_name + ".hpp"))) {
+            _code.append(_last, (*_it)[0].first);
+            _last = (*_it)[0].second;
+            _includes << "#include \"" << _name << ".hpp\"\n";
+        }
+    }
+    _code.append(_last, resolved_code.cend());
+    _code = std::regex_replace(_code, std::regex(R"(^[ \t]*#pragma[ \t]+OPENCL[^\n]*)", std::regex::multiline), "");
+    auto _keywords = std::vector<std::pair<std::string, std::string>> {
+        { "__kernel", "" }, { "kernel", "" }, { "__global", "" }, { "global", "" }, { "__constant", "" }, { "constant", "" }, { "__private", "" }, { "restrict", "__restrict" }
+    };
+    auto _oss = std::ostringstream {};
+    _oss << "#ifdef CLECS_NATIVE\n";
+    _oss << "#include <compute/core/native.hpp>\n";
+    _oss << _includes.str() << "\n";
+    _oss << "// C++ version of the kernel, executed on host threads by compute::native_registry\n";
+    for (const auto& _keyword : _keywords) {
+        _oss << "#define " << _keyword.first << (_keyword.second.empty() ? "" : " " + _keyword.second) << "\n";
+    }
+    _oss << "\nnamespace compute::native {\nnamespace {\nnamespace " << kernel_name << "_kernel {\n";
+    // translation units including the header without running the system natively never call smain
+    _code.insert(find_kernel(_code).begin, "[[maybe_unused]] ");
+    _oss << _code;
+    _oss << "}\n}\n}\n\n";
+    for (const auto& _keyword : _keywords) {
+        _oss << "#undef " << _keyword.first << "\n";
+    }
+    _oss << "#endif\n\n";
+    return _oss.str();
+}
+
+void generate_kernel_struct(const std::string& kernel_name, const std::string& resolved_code, const std::filesystem::path& include_base, const std::filesystem::path& output_path)
 {
+    auto _params = get_kernel_params(resolved_code);
     auto _ofs = std::ofstream(output_path);
     if (!_ofs.is_open()) {
         throw std::runtime_error("Failed to open output file: " + output_path.string());
     }
     _ofs << "#pragma once\n\n";
+    _ofs << "#include <string>\n";
+    _ofs << "#include <vector>\n\n";
+    _ofs << generate_native_code(kernel_name, resolved_code, include_base);
     _ofs << "struct " << kernel_name << " {\n";
+    auto _bounds_guard = accepts_bounds_guard(resolved_code);
     _ofs << "    inline static const std::string kernel_source = R\"(\n";
-    _ofs << resolved_code;
+    _ofs << (_bounds_guard ? add_bounds_guard(resolved_code) : resolved_code);
     _ofs << ")\";\n";
+    _ofs << "    static constexpr bool bounds_guard = " << (_bounds_guard ? "true" : "false") << ";\n";
+    _ofs << "    inline static const std::vector<bool> read_only_args = {";
+    for (std::size_t _k = 0; _k < _params.size(); ++_k) {
+        _ofs << (_k ? ", " : " ") << (is_read_only_param(_params[_k]) ? "true" : "false") << (_k + 1 == _params.size() ? " " : "");
+    }
+    _ofs << "};\n";
+    _ofs << "#ifdef CLECS_NATIVE\n";
+    _ofs << "    struct native_kernel {\n";
+    _ofs << "        template <typename... args_t>\n";
+    _ofs << "        static void smain(args_t... args) { compute::native::" << kernel_name << "_kernel::smain(args...); }\n";
+    _ofs << "    };\n";
+    _ofs << "#endif\n";
     _ofs << "};\n\n";
 }
 
+void generate_queue_helpers(const std::filesystem::path& output_path)
+{
+    auto _ofs = std::ofstream(output_path);
+    if (!_ofs.is_open()) {
+        throw std::runtime_error("Failed to open output file: " + output_path.string());
+    }
+    _ofs << "#ifndef CLECS_QUEUES\n";
+    _ofs << "#define CLECS_QUEUES\n\n";
+    _ofs << "// index of the entity processed by each work item, bound with compute::entity_ids\n";
+    _ofs << "#define clecs_entity_ids(var) __global const uint* var\n\n";
+    _ofs << "// spawn queue counter and capacity, followed by the component params of spawned entities\n";
+    _ofs << "#define clecs_queue_params(var) volatile __global uint* var##_count, uint var##_capacity\n";
+    _ofs << "#define clecs_destroy_params(var) clecs_queue_params(var), __global uint* var##_entities\n\n";
+    _ofs << "// reserves an element of a queue, or returns -1 once the queue is full\n";
+    _ofs << "int clecs_queue_reserve(volatile __global uint* count, uint capacity)\n";
+    _ofs << "{\n";
+    _ofs << "    uint k = atomic_inc(count);\n";
+    _ofs << "    return k < capacity ? (int)k : -1;\n";
+    _ofs << "}\n\n";
+    _ofs << "#define clecs_reserve(var) clecs_queue_reserve(var##_count, var##_capacity)\n";
+    _ofs << "#define clecs_destroy(var, id) do { int clecs_k = clecs_reserve(var); if (clecs_k >= 0) { var##_entities[clecs_k] = (id); } } while (0)\n\n";
+    _ofs << "#endif\n";
+}
+
 std::string get_struct_name(const std::filesystem::path& kernel_path)
 {
     return kernel_path.stem().string();
 }
 
+void generate_fused_struct(const std::filesystem::path& input_path, const std::filesystem::path& input_dir, const std::filesystem::path& include_base, const std::filesystem::path& output_dir)
+{
+    auto _ifs = std::ifstream(input_path);
+    if (!_ifs.is_open()) {
+        throw std::runtime_error("Failed to open file: " + input_path.string());
+    }
+    auto _isw = rapidjson::IStreamWrapper(_ifs);
+    auto _doc = rapidjson::Document {};
+    _doc.ParseStream(_isw);
+    if (_doc.HasParseError() || !_doc.IsObject() || !_doc.HasMember("name") || !_doc["name"].IsString() || !_doc.HasMember("systems") || !_doc["systems"].IsArray() || _doc["systems"].Empty()) {
+        throw std::runtime_error("Invalid fused system schema in: " + input_path.string());
+    }
+    auto _name = std::string(_doc["name"].GetString());
+    auto _systems = std::vector<std::string> {};
+    for (const auto& _system : _doc["systems"].GetArray()) {
+        if (!_system.IsString()) {
+            throw std::runtime_error("Invalid fused system schema in: " + input_path.string());
+        }
+        _systems.push_back(_system.GetString());
+    }
+    auto _output_file = output_dir / (_name + ".hpp");
+    generate_kernel_struct(_name, generate_fused_code(_name, _systems, input_dir, include_base), include_base, _output_file);
+    std::cout << "Generated fused system: " << _output_file << "\n";
+}
+
 int main(int argc, char* argv[])
 {
     if (argc != 3) {
@@ -73,6 +424,7 @@ int main(int argc, char* argv[])
         return 1;
     }
     std::filesystem::create_directories(_output_dir);
+    generate_queue_helpers(_output_dir / "clecs_queues.cl");
     for (const auto& _entry : std::filesystem::directory_iterator(_input_dir)) {
         if (_entry.path().extension() == ".cl") {
             try {
@@ -81,13 +433,22 @@ int main(int argc, char* argv[])
                 auto _resolved = resolve_includes(_kernel_source, _include_base, _visited);
                 auto _kernel_name = get_struct_name(_entry.path());
                 auto _output_file = _output_dir / (_kernel_name + ".hpp");
-                generate_kernel_struct(_kernel_name, _resolved, _output_file);
+                generate_kernel_struct(_kernel_name, _resolved, _include_base, _output_file);
                 std::cout << "Generated system: " << _output_file << "\n";
             } catch (const std::exception& ex) {
                 std::cout << "Error processing " << _entry.path() << ": " << ex.what() << "\n";
             }
         }
     }
+    for (const auto& _entry : std::filesystem::directory_iterator(_input_dir)) {
+        if (_entry.path().extension() == ".json") {
+            try {
+                generate_fused_struct(_entry.path(), _input_dir, _include_base, _output_dir);
+            } catch (const std::exception& ex) {
+                std::cout << "Error processing " << _entry.path() << ": " << ex.what() << "\n";
+            }
+        }
+    }
 
     return 0;
 }
@@ -0,0 +1,5 @@
+typedef struct {
+    float x;
+    float y;
+    float z;
+} position;
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <compute/core/opencl.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// generated component for host code, laid out like its OpenCL C counterpart
+struct alignas(4) position {
+    alignas(4) cl_float x;
+    alignas(4) cl_float y;
+    alignas(4) cl_float z;
+
+    inline static const std::vector<std::uint32_t> layout = { 12, 0, 4, 8 };
+    inline static const std::string layout_probe = R"(
+typedef struct {
+    float x;
+    float y;
+    float z;
+} position;
+
+kernel void clecs_layout(__global uint* layout)
+{
+    __global position* probe = (__global position*)layout;
+    layout[0] = sizeof(position);
+    layout[1] = (uint)((__global uchar*)&probe->x - (__global uchar*)probe);
+    layout[2] = (uint)((__global uchar*)&probe->y - (__global uchar*)probe);
+    layout[3] = (uint)((__global uchar*)&probe->z - (__global uchar*)probe);
+}
+)";
+
+    template <typename archive_t>
+    void serialize(archive_t& archive)
+    {
+        archive(x);
+        archive(y);
+        archive(z);
+    }
+};
+
+static_assert(sizeof(position) == 12, "position host size does not match its OpenCL C size");
+static_assert(offsetof(position, x) == 0, "position::x host offset does not match its OpenCL C offset");
+static_assert(offsetof(position, y) == 4, "position::y host offset does not match its OpenCL C offset");
+static_assert(offsetof(position, z) == 8, "position::z host offset does not match its OpenCL C offset");
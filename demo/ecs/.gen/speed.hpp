@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#ifdef CLECS_NATIVE
+#include <compute/core/native.hpp>
+#include "position.hpp"
+
+// C++ version of the kernel, executed on host threads by compute::native_registry
+#define __kernel
+#define kernel
+#define __global
+#define global
+#define __constant
+#define constant
+#define __private
+#define restrict __restrict
+
+namespace compute::native {
+namespace {
+namespace speed_kernel {
+
+
+
+[[maybe_unused]] kernel void smain(__global position* positions)
+{
+    int k = get_global_id(0);
+    positions[k].x = 1.2f + positions[k].x;
+    positions[k].y = 1.4f + positions[k].y;
+    positions[k].z = 1.6f + positions[k].z;
+} 
+}
+}
+}
+
+#undef __kernel
+#undef kernel
+#undef __global
+#undef global
+#undef __constant
+#undef constant
+#undef __private
+#undef restrict
+#endif
+
+struct speed {
+    inline static const std::string kernel_source = R"(
+typedef struct {
+    float x;
+    float y;
+    float z;
+} position;
+
+
+kernel void smain(__global position* positions, uint clecs_global_count)
+{
+    if (get_global_id(0) >= clecs_global_count) {
+        return;
+    }
+    int k = get_global_id(0);
+    positions[k].x = 1.2f + positions[k].x;
+    positions[k].y = 1.4f + positions[k].y;
+    positions[k].z = 1.6f + positions[k].z;
+} 
+)";
+    static constexpr bool bounds_guard = true;
+    inline static const std::vector<bool> read_only_args = { false };
+#ifdef CLECS_NATIVE
+    struct native_kernel {
+        template <typename... args_t>
+        static void smain(args_t... args) { compute::native::speed_kernel::smain(args...); }
+    };
+#endif
+};
+
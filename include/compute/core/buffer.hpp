@@ -1,19 +1,27 @@
 #pragma once
 
 #include <compute/core/context.hpp>
+#include <compute/core/event.hpp>
 
+#include <algorithm>
 #include <future>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace compute {
 
 /// @brief Represents a single device-resident value accessible via OpenCL.
 /// `buffer<value_t>` provides a thin abstraction over an OpenCL memory object
 /// holding a single instance of `value_t`. It is created inside a given `context`
-/// and supports asynchronous fetch back to host memory.
+/// and supports asynchronous fetch back to host memory. Transfers are enqueued without
+/// blocking and can wait for other device events through an optional wait list.
 /// @tparam value_t The type of the value stored in device memory.
 template <typename value_t>
 struct buffer {
 
+    using value_type = value_t;
+
     buffer(const buffer& other) = delete;
     buffer& operator=(const buffer& other) = delete;
     buffer(buffer&& other) noexcept;
@@ -28,18 +36,80 @@ struct buffer {
     /// @brief Sets the value on the device from host memory.
     /// This writes the specified value to device memory asynchronously.
     /// @param val The value to write to the buffer.
-    std::future<void> set(const value_t& val);
+    /// @param wait_list Events that must complete before the transfer starts.
+    future<void> set(const value_t& val, const std::vector<event>& wait_list = {});
 
     /// @brief Asynchronously fetches the value from device memory.
     /// Returns a future that will contain the host copy of the value once
     /// the transfer completes.
-    /// @return A `std::future<value_t>` that resolves with the current value.
-    [[nodiscard]] std::future<value_t> fetch();
+    /// @param wait_list Events that must complete before the transfer starts.
+    /// @return A `future<value_t>` that resolves with the current value.
+    [[nodiscard]] future<value_t> fetch(const std::vector<event>& wait_list = {});
+
+    /// @brief Names the commands issued by this buffer in the context profiler.
+    /// Has no effect unless the context was created with `CL_QUEUE_PROFILING_ENABLE`.
+    /// @param label The label under which transfers are recorded.
+    void set_label(const std::string& label);
 
 private:
     cl_mem _mem;
     cl_command_queue _queue;
+    std::shared_ptr<profiler> _profiler;
+    std::string _label;
     friend struct kernel;
+    void _track(cl_event evt, const char* category, std::size_t bytes);
+    void _release();
+};
+
+/// @brief Host view over a mapped range of an array buffer.
+/// `mapped_span<value_t>` gives direct host access to device memory mapped with
+/// `clEnqueueMapBuffer`. Values can be read or written in place without any extra copy
+/// or allocation; on devices sharing memory with the host (e.g., CPU devices) and for
+/// buffers created with `CL_MEM_ALLOC_HOST_PTR`, mapping is typically zero-copy. The range
+/// is unmapped when the span is destroyed, or explicitly with `unmap` to chain later
+/// device commands on it. Mapped spans are non-copyable but movable.
+/// @tparam value_t The type of each element in the mapped range.
+template <typename value_t>
+struct mapped_span {
+
+    mapped_span(const mapped_span& other) = delete;
+    mapped_span& operator=(const mapped_span& other) = delete;
+    mapped_span(mapped_span&& other) noexcept;
+    mapped_span& operator=(mapped_span&& other) noexcept;
+    ~mapped_span();
+
+    /// @brief Constructs an empty span not mapping any memory.
+    mapped_span() = default;
+
+    /// @brief Returns a pointer to the first mapped element, or `nullptr` once unmapped.
+    [[nodiscard]] value_t* data() const;
+
+    /// @brief Returns the number of mapped elements.
+    [[nodiscard]] std::size_t size() const;
+
+    /// @brief Returns an iterator to the first mapped element.
+    [[nodiscard]] value_t* begin() const;
+
+    /// @brief Returns an iterator past the last mapped element.
+    [[nodiscard]] value_t* end() const;
+
+    /// @brief Accesses a mapped element without bounds checking.
+    /// @param idx Index of the element in the mapped range.
+    value_t& operator[](std::size_t idx) const;
+
+    /// @brief Unmaps the range, making host writes visible to the device.
+    /// The span is empty afterwards. Unmapping an empty span is a no-op.
+    /// @param wait_list Events that must complete before the range is unmapped.
+    /// @return A future resolving once the range has been unmapped.
+    future<void> unmap(const std::vector<event>& wait_list = {});
+
+private:
+    cl_command_queue _queue = nullptr;
+    cl_mem _mem = nullptr;
+    value_t* _data = nullptr;
+    std::size_t _size = 0;
+    mapped_span(cl_command_queue queue, cl_mem mem, value_t* data, std::size_t sz);
+    template <typename> friend struct array_buffer;
     void _release();
 };
 
@@ -47,18 +117,21 @@ private:
 /// `array_buffer<value_t>` provides a resizable OpenCL buffer of elements of type `value_t`,
 /// designed for use in processing where systems operate over arrays
 /// of components directly in device memory. Like `buffer<value_t>`, values can be set or
-/// fetched from the host side asynchronously.
+/// fetched from the host side asynchronously. Buffers created with `CL_MEM_ALLOC_HOST_PTR`
+/// are allocated in pinned host-accessible memory, which makes `map` and transfers cheaper.
 /// @tparam value_t The type of each element in the buffer.
 template <typename value_t>
 struct array_buffer {
 
+    using value_type = value_t;
+
     array_buffer(const array_buffer& other) = delete;
     array_buffer& operator=(const array_buffer& other) = delete;
     array_buffer(array_buffer&& other) noexcept;
     array_buffer& operator=(array_buffer&& other) noexcept;
     ~array_buffer();
 
-    /// @brief Constructs an array buffer with a fixed size.
+    /// @brief Constructs an array buffer with an initial size.
     /// @param ctx The compute context this buffer will reside in.
     /// @param sz Number of elements to allocate.
     /// @param flags OpenCL memory flags (default: `CL_MEM_READ_WRITE`).
@@ -68,34 +141,153 @@ struct array_buffer {
     /// Throws std::out_of_range exception if index is greater than the buffer size.
     /// @param idx Index of the element to update.
     /// @param val The new value to write at the given index.
-    std::future<void> set(std::size_t idx, const value_t& val);
+    /// @param wait_list Events that must complete before the transfer starts.
+    future<void> set(std::size_t idx, const value_t& val, const std::vector<event>& wait_list = {});
 
     /// @brief Sets multiple values in the device buffer from host memory.
     /// Replaces the beginning of the buffer with the provided values.
     /// If fewer values are provided than the buffer size, only those are updated.
     /// Throws std::out_of_range exception if more values are provided than the buffer size.
     /// @param vals A vector of values to copy into the buffer.
-    std::future<void> set(const std::vector<value_t>& vals);
+    /// @param wait_list Events that must complete before the transfer starts.
+    future<void> set(const std::vector<value_t>& vals, const std::vector<event>& wait_list = {});
+
+    /// @brief Sets a contiguous range of values in the device buffer from host memory.
+    /// Only the elements in [offset, offset + vals.size()) are transferred.
+    /// Throws std::out_of_range exception if the range exceeds the buffer size.
+    /// @param offset Index of the first element to update.
+    /// @param vals A vector of values to copy into the buffer starting at `offset`.
+    /// @param wait_list Events that must complete before the transfer starts.
+    future<void> set(std::size_t offset, const std::vector<value_t>& vals, const std::vector<event>& wait_list = {});
+
+    /// @brief Sets multiple values in the device buffer, taking ownership of them.
+    /// Same as the `const` overload, without copying the values before the transfer.
+    /// @param vals A vector of values to move into the transfer.
+    /// @param wait_list Events that must complete before the transfer starts.
+    future<void> set(std::vector<value_t>&& vals, const std::vector<event>& wait_list = {});
+
+    /// @brief Sets a contiguous range of values, taking ownership of them.
+    /// Same as the `const` overload, without copying the values before the transfer.
+    /// @param offset Index of the first element to update.
+    /// @param vals A vector of values to move into the transfer.
+    /// @param wait_list Events that must complete before the transfer starts.
+    future<void> set(std::size_t offset, std::vector<value_t>&& vals, const std::vector<event>& wait_list = {});
+
+    /// @brief Fills a range of the device buffer with a single value.
+    /// Throws std::out_of_range exception if the range exceeds the buffer size.
+    /// As required by `clEnqueueFillBuffer`, the size of `value_t` must be a power of two up to 128 bytes.
+    /// @param val The value to write to every element of the range.
+    /// @param offset Index of the first element to fill.
+    /// @param count Number of elements to fill.
+    /// @param wait_list Events that must complete before the fill starts.
+    future<void> fill(const value_t& val, std::size_t offset, std::size_t count, const std::vector<event>& wait_list = {});
+
+    /// @brief Fills the whole device buffer with a single value.
+    /// The fill is performed on the device without any host-side staging. As required by
+    /// `clEnqueueFillBuffer`, the size of `value_t` must be a power of two up to 128 bytes.
+    /// @param val The value to write to every element.
+    /// @param wait_list Events that must complete before the fill starts.
+    future<void> fill(const value_t& val, const std::vector<event>& wait_list = {});
+
+    /// @brief Copies a range of elements from another array buffer, entirely on the device.
+    /// Throws std::out_of_range exception if either range exceeds its buffer size.
+    /// Overlapping ranges within the same buffer are not allowed.
+    /// @param src The array buffer to copy elements from (can be this buffer).
+    /// @param src_offset Index of the first element to copy in `src`.
+    /// @param dst_offset Index of the first element to overwrite in this buffer.
+    /// @param count Number of elements to copy.
+    /// @param wait_list Events that must complete before the copy starts.
+    future<void> copy(const array_buffer& src, std::size_t src_offset, std::size_t dst_offset, std::size_t count, const std::vector<event>& wait_list = {});
 
     /// @brief Asynchronously fetches a single element from device memory.
     /// Throws std::out_of_range exception if index is greater than the buffer size.
     /// @param idx Index of the element to fetch.
+    /// @param wait_list Events that must complete before the transfer starts.
     /// @return A future resolving to the value at the specified index.
-    [[nodiscard]] std::future<value_t> fetch(std::size_t idx);
+    [[nodiscard]] future<value_t> fetch(std::size_t idx, const std::vector<event>& wait_list = {});
 
     /// @brief Asynchronously fetches the entire array from the device.
+    /// @param wait_list Events that must complete before the transfer starts.
     /// @return A future resolving to a `std::vector` containing all elements.
-    [[nodiscard]] std::future<std::vector<value_t>> fetch();
+    [[nodiscard]] future<std::vector<value_t>> fetch(const std::vector<event>& wait_list = {});
+
+    /// @brief Asynchronously fetches the entire array into an existing vector.
+    /// The vector is resized to the buffer size, so reusing it across frames avoids any
+    /// allocation. It must stay alive and untouched until the future resolves.
+    /// @param dst The vector receiving the elements.
+    /// @param wait_list Events that must complete before the transfer starts.
+    /// @return A future resolving once `dst` holds the elements.
+    future<void> fetch(std::vector<value_t>& dst, const std::vector<event>& wait_list = {});
+
+    /// @brief Asynchronously fetches a range of elements into caller-provided memory.
+    /// Throws std::out_of_range exception if the range exceeds the buffer size.
+    /// The memory must stay alive until the future resolves.
+    /// @param dst Pointer to at least `count` elements receiving the range.
+    /// @param offset Index of the first element to fetch.
+    /// @param count Number of elements to fetch.
+    /// @param wait_list Events that must complete before the transfer starts.
+    /// @return A future resolving once `dst` holds the elements.
+    future<void> fetch(value_t* dst, std::size_t offset, std::size_t count, const std::vector<event>& wait_list = {});
+
+    /// @brief Maps a range of the buffer into host memory.
+    /// Throws std::out_of_range exception if the range exceeds the buffer size.
+    /// The buffer must not be resized while the range is mapped, and device commands
+    /// using the range must wait for it to be unmapped.
+    /// @param offset Index of the first element to map.
+    /// @param count Number of elements to map.
+    /// @param flags `CL_MAP_READ`, `CL_MAP_WRITE` or `CL_MAP_WRITE_INVALIDATE_REGION`.
+    /// @param wait_list Events that must complete before the range is mapped.
+    /// @return A future resolving to the mapped span once the range is accessible.
+    [[nodiscard]] future<mapped_span<value_t>> map(std::size_t offset, std::size_t count, cl_map_flags flags = CL_MAP_READ | CL_MAP_WRITE, const std::vector<event>& wait_list = {});
+
+    /// @brief Maps the whole buffer into host memory.
+    /// @param flags `CL_MAP_READ`, `CL_MAP_WRITE` or `CL_MAP_WRITE_INVALIDATE_REGION`.
+    /// @param wait_list Events that must complete before the buffer is mapped.
+    /// @return A future resolving to the mapped span once the buffer is accessible.
+    [[nodiscard]] future<mapped_span<value_t>> map(cl_map_flags flags = CL_MAP_READ | CL_MAP_WRITE, const std::vector<event>& wait_list = {});
+
+    /// @brief Ensures the device allocation can hold at least a given number of elements.
+    /// When the current capacity is too small, a new OpenCL buffer of exactly `capacity`
+    /// elements is allocated and the current elements are copied with `clEnqueueCopyBuffer`,
+    /// entirely on the device. The size of the buffer is left unchanged.
+    /// @param capacity Minimum number of elements the allocation must hold.
+    /// @param wait_list Events that must complete before the copy starts.
+    /// @return A future resolving once the elements have been copied.
+    future<void> reserve(std::size_t capacity, const std::vector<event>& wait_list = {});
+
+    /// @brief Changes the number of elements in the buffer.
+    /// Growing beyond the current capacity reallocates on the device with geometric
+    /// growth (at least doubling the capacity), so that repeated growth is amortized.
+    /// New elements are left uninitialized; shrinking never releases device memory.
+    /// @param sz The new number of elements.
+    /// @param wait_list Events that must complete before the copy starts.
+    /// @return A future resolving once the elements have been copied.
+    future<void> resize(std::size_t sz, const std::vector<event>& wait_list = {});
 
     /// @brief Returns the number of elements in the buffer.
     /// @return The current size of the array buffer.
     [[nodiscard]] std::size_t get_size() const;
 
+    /// @brief Returns the number of elements the device allocation can hold.
+    /// @return The current capacity of the array buffer.
+    [[nodiscard]] std::size_t get_capacity() const;
+
+    /// @brief Names the commands issued by this buffer in the context profiler.
+    /// Has no effect unless the context was created with `CL_QUEUE_PROFILING_ENABLE`.
+    /// @param label The label under which transfers are recorded.
+    void set_label(const std::string& label);
+
 private:
     std::size_t _size;
+    std::size_t _capacity;
     cl_mem _mem;
+    cl_context _context;
+    cl_mem_flags _flags;
     cl_command_queue _queue;
+    std::shared_ptr<profiler> _profiler;
+    std::string _label;
     friend struct kernel;
+    void _track(cl_event evt, const char* category, std::size_t bytes);
     void _release();
 };
 }
@@ -4,6 +4,8 @@ template <typename value_t>
 buffer<value_t>::buffer(buffer&& other) noexcept
     : _mem(other._mem)
     , _queue(other._queue)
+    , _profiler(std::move(other._profiler))
+    , _label(std::move(other._label))
 {
     other._mem = nullptr;
     other._queue = nullptr;
@@ -16,6 +18,8 @@ buffer<value_t>& buffer<value_t>::operator=(buffer&& other) noexcept
         _release();
         _mem = other._mem;
         _queue = other._queue;
+        _profiler = std::move(other._profiler);
+        _label = std::move(other._label);
         other._mem = nullptr;
         other._queue = nullptr;
     }
@@ -31,6 +35,7 @@ buffer<value_t>::~buffer()
 template <typename value_t>
 buffer<value_t>::buffer(const context& ctx, cl_mem_flags flags)
     : _queue(ctx._queue)
+    , _profiler(ctx._profiler)
 {
     auto _err = 0;
     _mem = clCreateBuffer(ctx._context, flags, sizeof(value_t), nullptr, &_err);
@@ -40,27 +45,45 @@ buffer<value_t>::buffer(const context& ctx, cl_mem_flags flags)
 }
 
 template <typename value_t>
-std::future<void> buffer<value_t>::set(const value_t& val)
+future<void> buffer<value_t>::set(const value_t& val, const std::vector<event>& wait_list)
 {
-    return std::async(std::launch::async, [this, val]() {
-        auto _err = clEnqueueWriteBuffer(_queue, _mem, CL_TRUE, 0, sizeof(value_t), &val, 0, nullptr, nullptr);
-        if (_err != CL_SUCCESS) {
-            throw std::runtime_error("Failed to write to OpenCL buffer");
-        }
-    });
+    auto _host = std::make_shared<value_t>(val);
+    auto _waits = native_events(wait_list);
+    auto _evt = cl_event {};
+    auto _err = clEnqueueWriteBuffer(_queue, _mem, CL_FALSE, 0, sizeof(value_t), _host.get(), _waits.size(), _waits.data(), &_evt);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to write to OpenCL buffer");
+    }
+    _track(_evt, "write", sizeof(value_t));
+    return detail::make_future<void>(_queue, _evt, [_host]() {});
 }
 
 template <typename value_t>
-std::future<value_t> buffer<value_t>::fetch()
+future<value_t> buffer<value_t>::fetch(const std::vector<event>& wait_list)
 {
-    return std::async(std::launch::async, [this]() {
-        auto _val = value_t {};
-        auto _err = clEnqueueReadBuffer(_queue, _mem, CL_TRUE, 0, sizeof(value_t), &_val, 0, nullptr, nullptr);
-        if (_err != CL_SUCCESS) {
-            throw std::runtime_error("Failed to read from OpenCL buffer");
-        }
-        return _val;
-    });
+    auto _host = std::make_shared<value_t>();
+    auto _waits = native_events(wait_list);
+    auto _evt = cl_event {};
+    auto _err = clEnqueueReadBuffer(_queue, _mem, CL_FALSE, 0, sizeof(value_t), _host.get(), _waits.size(), _waits.data(), &_evt);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to read from OpenCL buffer");
+    }
+    _track(_evt, "read", sizeof(value_t));
+    return detail::make_future<value_t>(_queue, _evt, [_host]() { return *_host; });
+}
+
+template <typename value_t>
+void buffer<value_t>::set_label(const std::string& label)
+{
+    _label = label;
+}
+
+template <typename value_t>
+void buffer<value_t>::_track(cl_event evt, const char* category, std::size_t bytes)
+{
+    if (_profiler) {
+        _profiler->_track(evt, _label, category, bytes);
+    }
 }
 
 template <typename value_t>
@@ -71,14 +94,133 @@ void buffer<value_t>::_release()
     }
 }
 
+template <typename value_t>
+mapped_span<value_t>::mapped_span(cl_command_queue queue, cl_mem mem, value_t* data, std::size_t sz)
+    : _queue(queue)
+    , _mem(mem)
+    , _data(data)
+    , _size(sz)
+{
+}
+
+template <typename value_t>
+mapped_span<value_t>::mapped_span(mapped_span&& other) noexcept
+    : _queue(other._queue)
+    , _mem(other._mem)
+    , _data(other._data)
+    , _size(other._size)
+{
+    other._queue = nullptr;
+    other._mem = nullptr;
+    other._data = nullptr;
+    other._size = 0;
+}
+
+template <typename value_t>
+mapped_span<value_t>& mapped_span<value_t>::operator=(mapped_span&& other) noexcept
+{
+    if (this != &other) {
+        _release();
+        _queue = other._queue;
+        _mem = other._mem;
+        _data = other._data;
+        _size = other._size;
+        other._queue = nullptr;
+        other._mem = nullptr;
+        other._data = nullptr;
+        other._size = 0;
+    }
+    return *this;
+}
+
+template <typename value_t>
+mapped_span<value_t>::~mapped_span()
+{
+    _release();
+}
+
+template <typename value_t>
+value_t* mapped_span<value_t>::data() const
+{
+    return _data;
+}
+
+template <typename value_t>
+std::size_t mapped_span<value_t>::size() const
+{
+    return _size;
+}
+
+template <typename value_t>
+value_t* mapped_span<value_t>::begin() const
+{
+    return _data;
+}
+
+template <typename value_t>
+value_t* mapped_span<value_t>::end() const
+{
+    return _data + _size;
+}
+
+template <typename value_t>
+value_t& mapped_span<value_t>::operator[](std::size_t idx) const
+{
+    return _data[idx];
+}
+
+template <typename value_t>
+future<void> mapped_span<value_t>::unmap(const std::vector<event>& wait_list)
+{
+    if (!_data) {
+        return detail::make_ready_future();
+    }
+    auto _waits = native_events(wait_list);
+    auto _evt = cl_event {};
+    auto _err = clEnqueueUnmapMemObject(_queue, _mem, _data, _waits.size(), _waits.data(), &_evt);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to unmap array buffer");
+    }
+    auto _future = detail::make_future<void>(_queue, _evt, []() {});
+    clReleaseMemObject(_mem);
+    clReleaseCommandQueue(_queue);
+    _queue = nullptr;
+    _mem = nullptr;
+    _data = nullptr;
+    _size = 0;
+    return _future;
+}
+
+template <typename value_t>
+void mapped_span<value_t>::_release()
+{
+    if (_data) {
+        clEnqueueUnmapMemObject(_queue, _mem, _data, 0, nullptr, nullptr);
+        clFlush(_queue);
+    }
+    if (_mem) {
+        clReleaseMemObject(_mem);
+    }
+    if (_queue) {
+        clReleaseCommandQueue(_queue);
+    }
+}
+
 template <typename value_t>
 array_buffer<value_t>::array_buffer(array_buffer&& other) noexcept
     : _size(other._size)
+    , _capacity(other._capacity)
     , _mem(other._mem)
+    , _context(other._context)
+    , _flags(other._flags)
     , _queue(other._queue)
+    , _profiler(std::move(other._profiler))
+    , _label(std::move(other._label))
 {
     other._size = 0;
+    other._capacity = 0;
     other._mem = nullptr;
+    other._context = nullptr;
     other._queue = nullptr;
 }
 
@@ -88,10 +230,17 @@ array_buffer<value_t>& array_buffer<value_t>::operator=(array_buffer&& other) no
     if (this != &other) {
         _release();
         _size = other._size;
+        _capacity = other._capacity;
         _mem = other._mem;
+        _context = other._context;
+        _flags = other._flags;
         _queue = other._queue;
+        _profiler = std::move(other._profiler);
+        _label = std::move(other._label);
         other._size = 0;
+        other._capacity = 0;
         other._mem = nullptr;
+        other._context = nullptr;
         other._queue = nullptr;
     }
     return *this;
@@ -106,70 +255,256 @@ array_buffer<value_t>::~array_buffer()
 template <typename value_t>
 array_buffer<value_t>::array_buffer(const context& ctx, const std::size_t sz, cl_mem_flags flags)
     : _size(sz)
+    , _capacity(sz)
+    , _context(ctx._context)
+    , _flags(flags)
     , _queue(ctx._queue)
+    , _profiler(ctx._profiler)
 {
     auto _err = 0;
-    _mem = clCreateBuffer(ctx._context, flags, sz * sizeof(value_t), nullptr, &_err);
+    _mem = clCreateBuffer(_context, _flags, sz * sizeof(value_t), nullptr, &_err);
     if (_err != CL_SUCCESS) {
         throw std::runtime_error("Failed to create OpenCL array buffer");
     }
 }
 
 template <typename value_t>
-std::future<void> array_buffer<value_t>::set(std::size_t idx, const value_t& val)
+future<void> array_buffer<value_t>::set(std::size_t idx, const value_t& val, const std::vector<event>& wait_list)
 {
-    return std::async(std::launch::async, [this, idx, val]() {
-        if (idx >= _size) {
-            throw std::out_of_range("Index out of bounds");
-        }
-        auto _err = clEnqueueWriteBuffer(_queue, _mem, CL_TRUE, idx * sizeof(value_t), sizeof(value_t), &val, 0, nullptr, nullptr);
-        if (_err != CL_SUCCESS) {
-            throw std::runtime_error("Failed to write element to array buffer");
-        }
-    });
+    if (idx >= _size) {
+        throw std::out_of_range("Index out of bounds");
+    }
+    auto _host = std::make_shared<value_t>(val);
+    auto _waits = native_events(wait_list);
+    auto _evt = cl_event {};
+    auto _err = clEnqueueWriteBuffer(_queue, _mem, CL_FALSE, idx * sizeof(value_t), sizeof(value_t), _host.get(), _waits.size(), _waits.data(), &_evt);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to write element to array buffer");
+    }
+    _track(_evt, "write", sizeof(value_t));
+    return detail::make_future<void>(_queue, _evt, [_host]() {});
 }
 
 template <typename value_t>
-std::future<void> array_buffer<value_t>::set(const std::vector<value_t>& vals)
+future<void> array_buffer<value_t>::set(const std::vector<value_t>& vals, const std::vector<event>& wait_list)
 {
-    return std::async(std::launch::async, [this, vals]() {
-        if (vals.size() > _size) {
-            throw std::out_of_range("Input vector size exceeds buffer size");
-        }
-        auto _err = clEnqueueWriteBuffer(_queue, _mem, CL_TRUE, 0, vals.size() * sizeof(value_t), vals.data(), 0, nullptr, nullptr);
-        if (_err != CL_SUCCESS) {
-            throw std::runtime_error("Failed to write vector to array buffer");
-        }
-    });
+    return set(0, vals, wait_list);
 }
 
 template <typename value_t>
-std::future<value_t> array_buffer<value_t>::fetch(std::size_t idx)
+future<void> array_buffer<value_t>::set(std::size_t offset, const std::vector<value_t>& vals, const std::vector<event>& wait_list)
 {
-    return std::async(std::launch::async, [this, idx]() {
-        if (idx >= _size) {
-            throw std::out_of_range("Index out of bounds");
-        }
-        auto _val = value_t {};
-        auto _err = clEnqueueReadBuffer(_queue, _mem, CL_TRUE, idx * sizeof(value_t), sizeof(value_t), &_val, 0, nullptr, nullptr);
-        if (_err != CL_SUCCESS) {
-            throw std::runtime_error("Failed to read element");
-        }
-        return _val;
+    if (offset + vals.size() > _size) {
+        throw std::out_of_range("Input range exceeds buffer size");
+    }
+    if (vals.empty()) {
+        return detail::make_ready_future();
+    }
+    return set(offset, std::vector<value_t>(vals), wait_list);
+}
+
+template <typename value_t>
+future<void> array_buffer<value_t>::set(std::vector<value_t>&& vals, const std::vector<event>& wait_list)
+{
+    return set(0, std::move(vals), wait_list);
+}
+
+template <typename value_t>
+future<void> array_buffer<value_t>::set(std::size_t offset, std::vector<value_t>&& vals, const std::vector<event>& wait_list)
+{
+    if (offset + vals.size() > _size) {
+        throw std::out_of_range("Input range exceeds buffer size");
+    }
+    if (vals.empty()) {
+        return detail::make_ready_future();
+    }
+    auto _host = std::make_shared<std::vector<value_t>>(std::move(vals));
+    auto _waits = native_events(wait_list);
+    auto _evt = cl_event {};
+    auto _err = clEnqueueWriteBuffer(_queue, _mem, CL_FALSE, offset * sizeof(value_t), _host->size() * sizeof(value_t), _host->data(), _waits.size(), _waits.data(), &_evt);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to write range to array buffer");
+    }
+    _track(_evt, "write", _host->size() * sizeof(value_t));
+    return detail::make_future<void>(_queue, _evt, [_host]() {});
+}
+
+template <typename value_t>
+future<void> array_buffer<value_t>::fill(const value_t& val, const std::vector<event>& wait_list)
+{
+    return fill(val, 0, _size, wait_list);
+}
+
+template <typename value_t>
+future<void> array_buffer<value_t>::fill(const value_t& val, std::size_t offset, std::size_t count, const std::vector<event>& wait_list)
+{
+    if (offset + count > _size) {
+        throw std::out_of_range("Fill range exceeds buffer size");
+    }
+    if (count == 0) {
+        return detail::make_ready_future();
+    }
+    auto _host = std::make_shared<value_t>(val);
+    auto _waits = native_events(wait_list);
+    auto _evt = cl_event {};
+    auto _err = clEnqueueFillBuffer(_queue, _mem, _host.get(), sizeof(value_t), offset * sizeof(value_t), count * sizeof(value_t), _waits.size(), _waits.data(), &_evt);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to fill array buffer");
+    }
+    _track(_evt, "fill", count * sizeof(value_t));
+    return detail::make_future<void>(_queue, _evt, [_host]() {});
+}
+
+template <typename value_t>
+future<void> array_buffer<value_t>::copy(const array_buffer& src, std::size_t src_offset, std::size_t dst_offset, std::size_t count, const std::vector<event>& wait_list)
+{
+    if (src_offset + count > src._size || dst_offset + count > _size) {
+        throw std::out_of_range("Copy range exceeds buffer size");
+    }
+    if (count == 0) {
+        return detail::make_ready_future();
+    }
+    auto _waits = native_events(wait_list);
+    auto _evt = cl_event {};
+    auto _err = clEnqueueCopyBuffer(_queue, src._mem, _mem, src_offset * sizeof(value_t), dst_offset * sizeof(value_t), count * sizeof(value_t), _waits.size(), _waits.data(), &_evt);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to copy array buffer");
+    }
+    _track(_evt, "copy", count * sizeof(value_t));
+    return detail::make_future<void>(_queue, _evt, []() {});
+}
+
+template <typename value_t>
+future<value_t> array_buffer<value_t>::fetch(std::size_t idx, const std::vector<event>& wait_list)
+{
+    if (idx >= _size) {
+        throw std::out_of_range("Index out of bounds");
+    }
+    auto _host = std::make_shared<value_t>();
+    auto _waits = native_events(wait_list);
+    auto _evt = cl_event {};
+    auto _err = clEnqueueReadBuffer(_queue, _mem, CL_FALSE, idx * sizeof(value_t), sizeof(value_t), _host.get(), _waits.size(), _waits.data(), &_evt);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to read element");
+    }
+    _track(_evt, "read", sizeof(value_t));
+    return detail::make_future<value_t>(_queue, _evt, [_host]() { return *_host; });
+}
+
+template <typename value_t>
+future<std::vector<value_t>> array_buffer<value_t>::fetch(const std::vector<event>& wait_list)
+{
+    auto _host = std::make_shared<std::vector<value_t>>(_size);
+    auto _waits = native_events(wait_list);
+    auto _evt = cl_event {};
+    auto _err = clEnqueueReadBuffer(_queue, _mem, CL_FALSE, 0, _size * sizeof(value_t), _host->data(), _waits.size(), _waits.data(), &_evt);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to read array buffer");
+    }
+    _track(_evt, "read", _size * sizeof(value_t));
+    return detail::make_future<std::vector<value_t>>(_queue, _evt, [_host]() { return std::move(*_host); });
+}
+
+template <typename value_t>
+future<void> array_buffer<value_t>::fetch(std::vector<value_t>& dst, const std::vector<event>& wait_list)
+{
+    dst.resize(_size);
+    return fetch(dst.data(), 0, _size, wait_list);
+}
+
+template <typename value_t>
+future<void> array_buffer<value_t>::fetch(value_t* dst, std::size_t offset, std::size_t count, const std::vector<event>& wait_list)
+{
+    if (offset + count > _size) {
+        throw std::out_of_range("Fetch range exceeds buffer size");
+    }
+    if (count == 0) {
+        return detail::make_ready_future();
+    }
+    auto _waits = native_events(wait_list);
+    auto _evt = cl_event {};
+    auto _err = clEnqueueReadBuffer(_queue, _mem, CL_FALSE, offset * sizeof(value_t), count * sizeof(value_t), dst, _waits.size(), _waits.data(), &_evt);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to read range from array buffer");
+    }
+    _track(_evt, "read", count * sizeof(value_t));
+    return detail::make_future<void>(_queue, _evt, []() {});
+}
+
+template <typename value_t>
+future<mapped_span<value_t>> array_buffer<value_t>::map(cl_map_flags flags, const std::vector<event>& wait_list)
+{
+    return map(0, _size, flags, wait_list);
+}
+
+template <typename value_t>
+future<mapped_span<value_t>> array_buffer<value_t>::map(std::size_t offset, std::size_t count, cl_map_flags flags, const std::vector<event>& wait_list)
+{
+    if (offset + count > _size) {
+        throw std::out_of_range("Map range exceeds buffer size");
+    }
+    if (count == 0) {
+        auto _promise = std::promise<mapped_span<value_t>> {};
+        _promise.set_value(mapped_span<value_t> {});
+        return future<mapped_span<value_t>>(_promise.get_future(), event {});
+    }
+    auto _waits = native_events(wait_list);
+    auto _evt = cl_event {};
+    auto _err = 0;
+    auto* _data = static_cast<value_t*>(clEnqueueMapBuffer(_queue, _mem, CL_FALSE, flags, offset * sizeof(value_t), count * sizeof(value_t), _waits.size(), _waits.data(), &_evt, &_err));
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to map array buffer");
+    }
+    _track(_evt, "map", count * sizeof(value_t));
+    // the span keeps the allocation and its queue alive even if the buffer is reallocated or destroyed
+    clRetainMemObject(_mem);
+    clRetainCommandQueue(_queue);
+    auto _queue_mapped = _queue;
+    auto _mem_mapped = _mem;
+    return detail::make_future<mapped_span<value_t>>(_queue, _evt, [_queue_mapped, _mem_mapped, _data, count]() {
+        return mapped_span<value_t>(_queue_mapped, _mem_mapped, _data, count);
     });
 }
 
 template <typename value_t>
-std::future<std::vector<value_t>> array_buffer<value_t>::fetch()
+future<void> array_buffer<value_t>::reserve(std::size_t capacity, const std::vector<event>& wait_list)
 {
-    return std::async(std::launch::async, [this]() {
-        auto _result = std::vector<value_t>(_size);
-        auto _err = clEnqueueReadBuffer(_queue, _mem, CL_TRUE, 0, _size * sizeof(value_t), _result.data(), 0, nullptr, nullptr);
+    if (capacity <= _capacity) {
+        return detail::make_ready_future();
+    }
+    auto _err = 0;
+    auto _mem_grown = clCreateBuffer(_context, _flags, capacity * sizeof(value_t), nullptr, &_err);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to grow OpenCL array buffer");
+    }
+    auto _result = detail::make_ready_future();
+    if (_size > 0) {
+        auto _waits = native_events(wait_list);
+        auto _evt = cl_event {};
+        _err = clEnqueueCopyBuffer(_queue, _mem, _mem_grown, 0, 0, _size * sizeof(value_t), _waits.size(), _waits.data(), &_evt);
         if (_err != CL_SUCCESS) {
-            throw std::runtime_error("Failed to read array buffer");
+            clReleaseMemObject(_mem_grown);
+            throw std::runtime_error("Failed to copy array buffer while growing");
         }
-        return _result;
-    });
+        _track(_evt, "copy", _size * sizeof(value_t));
+        _result = detail::make_future<void>(_queue, _evt, []() {});
+    }
+    // the previous allocation is only freed once the commands using it have completed
+    _release();
+    _mem = _mem_grown;
+    _capacity = capacity;
+    return _result;
+}
+
+template <typename value_t>
+future<void> array_buffer<value_t>::resize(std::size_t sz, const std::vector<event>& wait_list)
+{
+    auto _result = detail::make_ready_future();
+    if (sz > _capacity) {
+        _result = reserve(std::max(sz, _capacity * 2), wait_list);
+    }
+    _size = sz;
+    return _result;
 }
 
 template <typename value_t>
@@ -178,6 +513,26 @@ std::size_t array_buffer<value_t>::get_size() const
     return _size;
 }
 
+template <typename value_t>
+std::size_t array_buffer<value_t>::get_capacity() const
+{
+    return _capacity;
+}
+
+template <typename value_t>
+void array_buffer<value_t>::set_label(const std::string& label)
+{
+    _label = label;
+}
+
+template <typename value_t>
+void array_buffer<value_t>::_track(cl_event evt, const char* category, std::size_t bytes)
+{
+    if (_profiler) {
+        _profiler->_track(evt, _label, category, bytes);
+    }
+}
+
 template <typename value_t>
 void array_buffer<value_t>::_release()
 {
@@ -1,6 +1,12 @@
 #pragma once
 
 #include <compute/core/device.hpp>
+#include <compute/core/event.hpp>
+#include <compute/core/profiler.hpp>
+#include <compute/core/program_cache.hpp>
+
+#include <memory>
+#include <vector>
 
 namespace compute {
 
@@ -9,6 +15,9 @@ namespace compute {
 /// used for executing kernels and managing memory buffers. It is tightly coupled with a specific
 /// OpenCL device. Contexts are non-copyable but movable. They manage ownership of the underlying
 /// OpenCL context and command queue, and clean them up automatically on destruction.
+/// A context created from a sub-device returned by `device::partition_by_affinity` or
+/// `device::partition_equally` allocates its buffers and runs its kernels on that partition
+/// only, which keeps a registry built on it local to one NUMA node.
 struct context {
 
     context(const context& other) = delete;
@@ -22,12 +31,47 @@ struct context {
     /// to interact with device memory and launch compute kernels.
     /// @param dev The `device` instance this context will be associated with.
     /// @param props Optional additional OpenCL context properties (can be empty).
-    context(const device& dev, const std::vector<cl_context_properties>& props = {});
+    /// @param queue_props OpenCL command queue properties. Passing `CL_QUEUE_PROFILING_ENABLE`
+    /// records device timings of every command in the profiler returned by `get_profiler`.
+    /// @param queues_count Number of in-order command queues to create (at least 1). Queue 0
+    /// is used for all transfers; the other queues let kernels run concurrently when they
+    /// are dispatched on different queues and only ordered by events.
+    context(const device& dev, const std::vector<cl_context_properties>& props = {}, cl_command_queue_properties queue_props = 0, std::size_t queues_count = 1);
+
+    /// @brief Attaches an on-disk program binary cache to this context.
+    /// Kernels built in this context afterwards reload their binaries from the cache
+    /// when possible. Passing `nullptr` disables the cache again.
+    /// @param cache The program cache to use (can be shared between contexts).
+    void set_program_cache(const std::shared_ptr<program_cache>& cache);
+
+    /// @brief Returns the program binary cache attached to this context.
+    /// @return The attached cache, or `nullptr` if caching is disabled.
+    [[nodiscard]] std::shared_ptr<program_cache> get_program_cache() const;
+
+    /// @brief Returns the profiler recording the commands enqueued in this context.
+    /// @return The profiler, or `nullptr` if the context was created without `CL_QUEUE_PROFILING_ENABLE`.
+    [[nodiscard]] std::shared_ptr<profiler> get_profiler() const;
+
+    /// @brief Returns the number of command queues of this context.
+    /// @return The number of queues kernels can be dispatched on.
+    [[nodiscard]] std::size_t get_queues_count() const;
+
+    /// @brief Enqueues a barrier on one of the command queues.
+    /// Commands enqueued afterwards on this queue wait for every previous command of the
+    /// queue and for the events of the wait list, which joins work done on other queues.
+    /// Throws std::out_of_range if the queue index is greater than the number of queues.
+    /// @param wait_list Events that must complete before the barrier is passed.
+    /// @param queue_idx Index of the queue to enqueue the barrier on.
+    /// @return A future resolving once the barrier has been passed.
+    future<void> barrier(const std::vector<event>& wait_list = {}, std::size_t queue_idx = 0) const;
 
 private:
     cl_device_id _device;
     cl_context _context;
     cl_command_queue _queue;
+    std::vector<cl_command_queue> _concurrent_queues;
+    std::shared_ptr<program_cache> _program_cache;
+    std::shared_ptr<profiler> _profiler;
     template <typename value_t> friend struct buffer;
     template <typename value_t> friend struct array_buffer;
     friend struct kernel;
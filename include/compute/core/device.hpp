@@ -18,6 +18,7 @@ struct device {
     device& operator=(const device& other) = delete;
     device(device&& other) noexcept;
     device& operator=(device&& other) noexcept;
+    ~device();
 
     /// @brief Constructs a device from an OpenCL platform and device ID.
     /// @param plat The OpenCL platform associated with the device.
@@ -28,6 +29,33 @@ struct device {
     /// @return A human-readable string representing the device name.
     [[nodiscard]] std::string get_name() const;
 
+    /// @brief Returns the number of parallel compute units of the device.
+    /// For CPU devices, this is the number of hardware threads the device runs kernels on.
+    /// @return The value of `CL_DEVICE_MAX_COMPUTE_UNITS`.
+    [[nodiscard]] std::size_t get_compute_units() const;
+
+    /// @brief Returns whether this device is a partition created from another device.
+    /// @return `true` if the device was created by `partition_by_affinity` or `partition_equally`.
+    [[nodiscard]] bool is_sub_device() const;
+
+    /// @brief Partitions the device into sub-devices sharing a memory or cache affinity domain.
+    /// With `CL_DEVICE_AFFINITY_DOMAIN_NUMA`, a CPU device spanning several sockets is split
+    /// into one sub-device per NUMA node. A `context` created from a sub-device only runs
+    /// kernels on the compute units of its partition, so component stores and systems of a
+    /// `registry` built on it stay local to one socket. Sub-devices are released when the
+    /// last `device` and `context` referring to them are destroyed.
+    /// Throws std::runtime_error if the device cannot be partitioned along this domain.
+    /// @param domain The affinity domain to partition along (default: `CL_DEVICE_AFFINITY_DOMAIN_NUMA`).
+    /// @return The sub-devices, one per affinity domain.
+    [[nodiscard]] std::vector<device> partition_by_affinity(cl_device_affinity_domain domain = CL_DEVICE_AFFINITY_DOMAIN_NUMA) const;
+
+    /// @brief Partitions the device into sub-devices with the same number of compute units.
+    /// Compute units left over after the last full partition are not used.
+    /// Throws std::runtime_error if the device cannot be partitioned this way.
+    /// @param compute_units Number of compute units of every sub-device.
+    /// @return The sub-devices, as many as fit in the device.
+    [[nodiscard]] std::vector<device> partition_equally(std::size_t compute_units) const;
+
     /// @brief Returns the total number of OpenCL-compatible devices available on the system.
     /// @return Number of available OpenCL devices.
     [[nodiscard]] static std::size_t get_devices_count();
@@ -45,6 +73,8 @@ struct device {
 private:
     cl_platform_id _platform;
     cl_device_id _device;
+    bool _sub_device;
+    [[nodiscard]] std::vector<device> _partition(const std::vector<cl_device_partition_property>& props) const;
     friend struct context;
 };
 
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <compute/core/opencl.hpp>
+
+#include <functional>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace compute {
+
+/// @brief Represents the completion of a command enqueued on the device.
+/// `event` is a reference-counted handle over an OpenCL event. Every asynchronous
+/// operation (buffer transfers, kernel dispatches) produces one, and operations accept
+/// a list of events to wait for, so that transfers and dispatches can be chained on the
+/// device without any host synchronization. Events are copyable and movable.
+struct event {
+
+    event(const event& other);
+    event& operator=(const event& other);
+    event(event&& other) noexcept;
+    event& operator=(event&& other) noexcept;
+    ~event();
+
+    /// @brief Constructs an empty event that is considered already complete.
+    event();
+
+    /// @brief Constructs an event from an OpenCL event, taking ownership of it.
+    /// @param evt The OpenCL event to wrap.
+    explicit event(cl_event evt);
+
+    /// @brief Blocks the calling thread until the command has completed on the device.
+    void wait() const;
+
+    /// @brief Returns whether the command has completed on the device.
+    /// @return `true` if the command completed (or the event is empty).
+    [[nodiscard]] bool is_complete() const;
+
+private:
+    cl_event _event;
+    template <typename value_t> friend struct buffer;
+    template <typename value_t> friend struct array_buffer;
+    friend struct kernel;
+    friend struct native_events;
+};
+
+/// @brief Result of an asynchronous device operation.
+/// `future<value_t>` behaves like a `std::future<value_t>` whose value is delivered by an
+/// OpenCL completion callback rather than by a helper thread. It also exposes the
+/// underlying `event`, so that dependent operations can wait for it on the device.
+/// Futures are non-copyable but movable.
+/// @tparam value_t The type of the value produced by the operation.
+template <typename value_t>
+struct future {
+
+    future(const future& other) = delete;
+    future& operator=(const future& other) = delete;
+    future(future&& other) noexcept = default;
+    future& operator=(future&& other) noexcept = default;
+
+    /// @brief Constructs an invalid future not associated with any operation.
+    future() = default;
+
+    /// @brief Constructs a future from a host future and the event it is bound to.
+    /// @param fut The host future fulfilled when the operation completes.
+    /// @param evt The event of the operation on the device.
+    future(std::future<value_t>&& fut, const event& evt);
+
+    /// @brief Waits for the operation to complete and returns its result.
+    /// Rethrows any error raised while the operation executed.
+    /// @return The value produced by the operation.
+    value_t get();
+
+    /// @brief Blocks the calling thread until the result is available.
+    void wait() const;
+
+    /// @brief Returns whether this future refers to an operation.
+    /// @return `true` if `get` can be called.
+    [[nodiscard]] bool valid() const;
+
+    /// @brief Returns the device event of the operation.
+    /// Pass it in the wait list of later operations to chain them on the device.
+    /// @return The event signaled when the operation completes.
+    [[nodiscard]] const event& get_event() const;
+
+private:
+    std::future<value_t> _future;
+    event _event;
+};
+
+/// @brief Contiguous array of OpenCL events built from a wait list.
+/// This is the form expected by `clEnqueue*` functions, including the requirement
+/// that an empty wait list is passed as a null pointer.
+struct native_events {
+
+    /// @brief Collects the non-empty events of a wait list.
+    /// @param events The events to wait for.
+    native_events(const std::vector<event>& events);
+
+    /// @brief Returns the number of events.
+    [[nodiscard]] cl_uint size() const;
+
+    /// @brief Returns a pointer to the events, or `nullptr` if there are none.
+    [[nodiscard]] const cl_event* data() const;
+
+private:
+    std::vector<cl_event> _events;
+};
+
+namespace detail {
+
+    template <typename value_t>
+    struct completion {
+        std::promise<value_t> promise;
+        std::function<value_t()> resolve;
+    };
+
+    template <typename value_t>
+    void CL_CALLBACK on_complete(cl_event evt, cl_int status, void* user_data);
+
+    /// @brief Flushes the queue and returns a future fulfilled when the command completes.
+    /// The `resolve` function is invoked from the OpenCL completion callback and produces
+    /// the value of the future. It also keeps alive any host memory used by the command.
+    template <typename value_t>
+    future<value_t> make_future(cl_command_queue queue, cl_event evt, std::function<value_t()> resolve);
+
+    /// @brief Returns an already completed future, used when there is nothing to enqueue.
+    future<void> make_ready_future();
+
+}
+
+}
+
+#include "event.inl"
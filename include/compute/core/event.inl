@@ -0,0 +1,76 @@
+namespace compute {
+
+template <typename value_t>
+future<value_t>::future(std::future<value_t>&& fut, const event& evt)
+    : _future(std::move(fut))
+    , _event(evt)
+{
+}
+
+template <typename value_t>
+value_t future<value_t>::get()
+{
+    return _future.get();
+}
+
+template <typename value_t>
+void future<value_t>::wait() const
+{
+    _future.wait();
+}
+
+template <typename value_t>
+bool future<value_t>::valid() const
+{
+    return _future.valid();
+}
+
+template <typename value_t>
+const event& future<value_t>::get_event() const
+{
+    return _event;
+}
+
+namespace detail {
+
+    template <typename value_t>
+    void CL_CALLBACK on_complete(cl_event evt, cl_int status, void* user_data)
+    {
+        auto* _completion = static_cast<completion<value_t>*>(user_data);
+        if (status != CL_COMPLETE) {
+            _completion->promise.set_exception(std::make_exception_ptr(std::runtime_error("OpenCL command failed with status " + std::to_string(status))));
+        } else {
+            try {
+                if constexpr (std::is_void_v<value_t>) {
+                    _completion->resolve();
+                    _completion->promise.set_value();
+                } else {
+                    _completion->promise.set_value(_completion->resolve());
+                }
+            } catch (...) {
+                _completion->promise.set_exception(std::current_exception());
+            }
+        }
+        delete _completion;
+        clReleaseEvent(evt);
+    }
+
+    template <typename value_t>
+    future<value_t> make_future(cl_command_queue queue, cl_event evt, std::function<value_t()> resolve)
+    {
+        auto _event = event(evt);
+        auto* _completion = new completion<value_t> { std::promise<value_t> {}, std::move(resolve) };
+        auto _future = future<value_t>(_completion->promise.get_future(), _event);
+        clRetainEvent(evt);
+        if (clSetEventCallback(evt, CL_COMPLETE, &on_complete<value_t>, _completion) != CL_SUCCESS) {
+            clReleaseEvent(evt);
+            delete _completion;
+            throw std::runtime_error("Failed to set OpenCL event callback");
+        }
+        clFlush(queue);
+        return _future;
+    }
+
+}
+
+}
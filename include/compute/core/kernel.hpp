@@ -2,8 +2,12 @@
 
 #include <compute/core/buffer.hpp>
 #include <compute/core/context.hpp>
+#include <compute/core/event.hpp>
 
+#include <filesystem>
+#include <map>
 #include <string>
+#include <type_traits>
 
 namespace compute {
 
@@ -27,7 +31,8 @@ struct kernel {
     /// @param ctx The execution context and device this kernel is bound to.
     /// @param str OpenCL C source code as a string.
     /// @param name The name of the kernel function to extract and run.
-    kernel(const context& ctx, const std::string& str, const std::string& name);
+    /// @param options Build options forwarded to the OpenCL compiler (e.g., `-cl-fast-relaxed-math`).
+    kernel(const context& ctx, const std::string& str, const std::string& name, const std::string& options = "");
 
     /// @brief Sets a kernel argument using a device buffer.
     /// Binds a `buffer<value_t>` as a kernel argument at the specified index.
@@ -45,19 +50,86 @@ struct kernel {
     template <typename value_t>
     void set_arg(const std::size_t idx, array_buffer<value_t>& buf);
 
+    /// @brief Sets a kernel argument by value.
+    /// Binds a trivially copyable value (e.g., `cl_float`, `cl_float4` or a generated
+    /// component struct) as a kernel argument at the specified index. The value is copied
+    /// by the driver, so no device buffer or transfer is needed and the kernel can be
+    /// rebound with a new value as soon as this returns.
+    /// @tparam value_t Type of the value, matching the kernel parameter type.
+    /// @param idx Index of the kernel argument.
+    /// @param val The value to pass to the kernel.
+    template <typename value_t, typename = std::enable_if_t<std::is_trivially_copyable_v<value_t>>>
+    void set_arg(const std::size_t idx, const value_t& val);
+
     /// @brief Launches the kernel with the specified global work size.
     /// Executes the kernel on the associated device using the provided
     /// global work dimensions. The kernel must be fully configured with all
-    /// arguments set prior to execution.
+    /// arguments set prior to execution. Arguments are captured at enqueue time,
+    /// so they can be rebound as soon as this returns.
+    /// Throws std::out_of_range if the queue index is greater than the number of queues.
     /// @param wsz Vector of global work sizes for each dimension (e.g., 1D, 2D, 3D).
-    std::future<void> run(const std::vector<std::size_t>& wsz);
+    /// @param wait_list Events that must complete before the kernel starts.
+    /// @param queue_idx Index of the context queue to enqueue the kernel on.
+    /// @param lsz Vector of local work sizes for each dimension, dividing the global work
+    /// sizes. When empty, the driver picks the work-group size.
+    future<void> run(const std::vector<std::size_t>& wsz, const std::vector<event>& wait_list = {}, std::size_t queue_idx = 0, const std::vector<std::size_t>& lsz = {});
+
+    /// @brief Launches the kernel over a 1D range with an automatically tuned work-group size.
+    /// Work-item counts are grouped into power-of-two buckets. While a bucket is being tuned,
+    /// successive dispatches cycle through candidate local sizes (multiples of the preferred
+    /// work-group size multiple, up to the maximum work-group size), and their durations are
+    /// read from profiling events once they complete. When every candidate has been measured
+    /// a few times, the fastest one is used for all later dispatches of the bucket, and is
+    /// written next to the program binary if the context has a program cache. Tuning requires
+    /// a context created with `CL_QUEUE_PROFILING_ENABLE`; otherwise only the sizes found in
+    /// the program cache are used, and the driver picks the others. The global size is padded
+    /// up to a multiple of the local size, so the kernel must ignore the work-items whose
+    /// global id is greater than or equal to `count`.
+    /// Throws std::out_of_range if the queue index is greater than the number of queues.
+    /// @param count Number of work-items to process.
+    /// @param wait_list Events that must complete before the kernel starts.
+    /// @param queue_idx Index of the context queue to enqueue the kernel on.
+    future<void> run_tuned(std::size_t count, const std::vector<event>& wait_list = {}, std::size_t queue_idx = 0);
+
+    /// @brief Returns the largest work-group size this kernel can be launched with on its device.
+    /// @return The value of `CL_KERNEL_WORK_GROUP_SIZE`.
+    [[nodiscard]] std::size_t get_max_work_group_size() const;
+
+    /// @brief Returns the multiple of work-group size the device runs most efficiently.
+    /// @return The value of `CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE`.
+    [[nodiscard]] std::size_t get_preferred_work_group_multiple() const;
+
+    /// @brief Returns the local size chosen by `run_tuned` for a number of work-items.
+    /// @param count Number of work-items of the dispatch.
+    /// @return The tuned local size, or zero while the size is unknown or still being tuned.
+    [[nodiscard]] std::size_t get_tuned_local_size(std::size_t count) const;
+
+    /// @brief Names the dispatches of this kernel in the context profiler.
+    /// Has no effect unless the context was created with `CL_QUEUE_PROFILING_ENABLE`.
+    /// @param label The label under which dispatches are recorded.
+    void set_label(const std::string& label);
 
 private:
+    struct work_group_tuning {
+        std::size_t local_size = 0;
+        std::vector<std::size_t> candidates;
+        std::vector<std::size_t> samples;
+        std::vector<cl_ulong> durations;
+        std::vector<std::pair<std::size_t, event>> pending;
+        std::size_t dispatched = 0;
+    };
     cl_device_id _device;
     cl_context _context;
-    cl_command_queue _command_queue;
+    std::vector<cl_command_queue> _command_queues;
     cl_program _program;
     cl_kernel _kernel;
+    std::shared_ptr<profiler> _profiler;
+    std::string _label;
+    std::shared_ptr<program_cache> _cache;
+    std::filesystem::path _work_groups_path;
+    std::map<std::size_t, work_group_tuning> _tunings;
+    work_group_tuning& _get_or_create_tuning(std::size_t bucket);
+    void _collect_samples(work_group_tuning& tuning);
 };
 
 }
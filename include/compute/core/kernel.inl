@@ -18,4 +18,13 @@ void kernel::set_arg(const std::size_t idx, array_buffer<value_t>& buf)
     }
 }
 
+template <typename value_t, typename>
+void kernel::set_arg(const std::size_t idx, const value_t& val)
+{
+    auto _err = clSetKernelArg(_kernel, static_cast<cl_uint>(idx), sizeof(value_t), &val);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to set value kernel argument at index " + std::to_string(idx));
+    }
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,329 @@
+#pragma once
+
+#include <compute/core/opencl.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <type_traits>
+
+namespace compute {
+
+/// @brief Subset of the OpenCL C built-ins for kernels compiled as native C++.
+/// systemc emits a C++ version of every system inside this namespace when `CLECS_NATIVE`
+/// is defined, so that `native_registry` can call it from host threads. Work-items run one
+/// at a time per thread, in work-groups of a single item: `barrier` is a no-op and `__local`
+/// memory is not supported. OpenCL vector types are the `cl_` host types, with component-wise
+/// arithmetic, but vector literals such as `(float4)(0.0f)` and swizzles are not supported.
+namespace native {
+
+    /// @brief Position of the work-item currently executed by the calling thread.
+    struct work_item {
+        std::size_t global_id = 0;
+        std::size_t global_size = 1;
+    };
+
+    inline thread_local work_item current_work_item;
+
+    using uchar = cl_uchar;
+    using ushort = cl_ushort;
+    using uint = cl_uint;
+    using ulong = cl_ulong;
+    using float2 = cl_float2;
+    using float3 = cl_float3;
+    using float4 = cl_float4;
+    using int2 = cl_int2;
+    using int3 = cl_int3;
+    using int4 = cl_int4;
+    using uint2 = cl_uint2;
+    using uint3 = cl_uint3;
+    using uint4 = cl_uint4;
+
+    constexpr cl_uint CLK_LOCAL_MEM_FENCE = 1;
+    constexpr cl_uint CLK_GLOBAL_MEM_FENCE = 2;
+
+    inline uint get_work_dim() { return 1; }
+    inline std::size_t get_global_id(uint dim) { return dim == 0 ? current_work_item.global_id : 0; }
+    inline std::size_t get_global_size(uint dim) { return dim == 0 ? current_work_item.global_size : 1; }
+    inline std::size_t get_global_offset(uint) { return 0; }
+    inline std::size_t get_local_id(uint) { return 0; }
+    inline std::size_t get_local_size(uint) { return 1; }
+    inline std::size_t get_group_id(uint dim) { return get_global_id(dim); }
+    inline std::size_t get_num_groups(uint dim) { return get_global_size(dim); }
+    inline void barrier(cl_uint) { }
+    inline void mem_fence(cl_uint) { std::atomic_thread_fence(std::memory_order_seq_cst); }
+
+    template <typename vector_t>
+    struct vector_traits {
+        static constexpr std::size_t lanes = 0;
+    };
+
+    template <>
+    struct vector_traits<cl_float2> {
+        using scalar = cl_float;
+        static constexpr std::size_t lanes = 2;
+    };
+
+    template <>
+    struct vector_traits<cl_float4> {
+        using scalar = cl_float;
+        static constexpr std::size_t lanes = 4;
+    };
+
+    template <>
+    struct vector_traits<cl_int2> {
+        using scalar = cl_int;
+        static constexpr std::size_t lanes = 2;
+    };
+
+    template <>
+    struct vector_traits<cl_int4> {
+        using scalar = cl_int;
+        static constexpr std::size_t lanes = 4;
+    };
+
+    template <>
+    struct vector_traits<cl_uint2> {
+        using scalar = cl_uint;
+        static constexpr std::size_t lanes = 2;
+    };
+
+    template <>
+    struct vector_traits<cl_uint4> {
+        using scalar = cl_uint;
+        static constexpr std::size_t lanes = 4;
+    };
+
+    template <typename vector_t>
+    inline constexpr bool is_vector_v = vector_traits<vector_t>::lanes != 0;
+
+    template <typename vector_t>
+    using scalar_t = typename vector_traits<vector_t>::scalar;
+
+    namespace detail {
+
+        template <typename vector_t, typename function_t>
+        vector_t map_lanes(vector_t a, const vector_t& b, function_t func)
+        {
+            for (std::size_t _k = 0; _k < vector_traits<vector_t>::lanes; ++_k) {
+                a.s[_k] = func(a.s[_k], b.s[_k]);
+            }
+            return a;
+        }
+
+        template <typename vector_t>
+        vector_t splat(scalar_t<vector_t> value)
+        {
+            auto _vector = vector_t {};
+            for (std::size_t _k = 0; _k < vector_traits<vector_t>::lanes; ++_k) {
+                _vector.s[_k] = value;
+            }
+            return _vector;
+        }
+
+    }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    vector_t operator+(const vector_t& a, const vector_t& b) { return detail::map_lanes(a, b, [](auto x, auto y) { return x + y; }); }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    vector_t operator-(const vector_t& a, const vector_t& b) { return detail::map_lanes(a, b, [](auto x, auto y) { return x - y; }); }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    vector_t operator*(const vector_t& a, const vector_t& b) { return detail::map_lanes(a, b, [](auto x, auto y) { return x * y; }); }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    vector_t operator/(const vector_t& a, const vector_t& b) { return detail::map_lanes(a, b, [](auto x, auto y) { return x / y; }); }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    vector_t operator*(const vector_t& a, scalar_t<vector_t> b) { return a * detail::splat<vector_t>(b); }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    vector_t operator*(scalar_t<vector_t> a, const vector_t& b) { return detail::splat<vector_t>(a) * b; }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    vector_t operator/(const vector_t& a, scalar_t<vector_t> b) { return a / detail::splat<vector_t>(b); }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    vector_t operator-(const vector_t& a) { return detail::splat<vector_t>(0) - a; }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    vector_t& operator+=(vector_t& a, const vector_t& b) { return a = a + b; }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    vector_t& operator-=(vector_t& a, const vector_t& b) { return a = a - b; }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    vector_t& operator*=(vector_t& a, scalar_t<vector_t> b) { return a = a * b; }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    vector_t& operator/=(vector_t& a, scalar_t<vector_t> b) { return a = a / b; }
+
+    using std::abs;
+    using std::acos;
+    using std::asin;
+    using std::atan;
+    using std::atan2;
+    using std::cbrt;
+    using std::ceil;
+    using std::copysign;
+    using std::cos;
+    using std::exp;
+    using std::exp2;
+    using std::fabs;
+    using std::floor;
+    using std::fma;
+    using std::fmax;
+    using std::fmin;
+    using std::fmod;
+    using std::hypot;
+    using std::log;
+    using std::log2;
+    using std::pow;
+    using std::printf;
+    using std::round;
+    using std::sin;
+    using std::sqrt;
+    using std::tan;
+    using std::trunc;
+
+    inline cl_float rsqrt(cl_float x) { return 1.0f / std::sqrt(x); }
+    inline cl_float native_sqrt(cl_float x) { return std::sqrt(x); }
+    inline cl_float native_rsqrt(cl_float x) { return 1.0f / std::sqrt(x); }
+    inline cl_float native_recip(cl_float x) { return 1.0f / x; }
+    inline cl_float native_divide(cl_float x, cl_float y) { return x / y; }
+    inline cl_float native_sin(cl_float x) { return std::sin(x); }
+    inline cl_float native_cos(cl_float x) { return std::cos(x); }
+    inline cl_float native_exp(cl_float x) { return std::exp(x); }
+    inline cl_float native_log(cl_float x) { return std::log(x); }
+    inline cl_float mad(cl_float a, cl_float b, cl_float c) { return a * b + c; }
+    inline cl_float radians(cl_float x) { return x * 0.01745329251994329577f; }
+    inline cl_float degrees(cl_float x) { return x * 57.2957795130823208768f; }
+    inline cl_float sign(cl_float x) { return x > 0.0f ? 1.0f : (x < 0.0f ? -1.0f : 0.0f); }
+    inline cl_float step(cl_float edge, cl_float x) { return x < edge ? 0.0f : 1.0f; }
+
+    template <typename value_t, typename other_t, typename = std::enable_if_t<std::is_arithmetic_v<value_t> && std::is_arithmetic_v<other_t>>>
+    std::common_type_t<value_t, other_t> min(value_t a, other_t b) { return b < a ? b : a; }
+
+    template <typename value_t, typename other_t, typename = std::enable_if_t<std::is_arithmetic_v<value_t> && std::is_arithmetic_v<other_t>>>
+    std::common_type_t<value_t, other_t> max(value_t a, other_t b) { return a < b ? b : a; }
+
+    template <typename value_t, typename low_t, typename high_t, typename = std::enable_if_t<std::is_arithmetic_v<value_t>>>
+    value_t clamp(value_t x, low_t low, high_t high) { return x < low ? static_cast<value_t>(low) : (high < x ? static_cast<value_t>(high) : x); }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    vector_t min(const vector_t& a, const vector_t& b) { return detail::map_lanes(a, b, [](auto x, auto y) { return y < x ? y : x; }); }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    vector_t max(const vector_t& a, const vector_t& b) { return detail::map_lanes(a, b, [](auto x, auto y) { return x < y ? y : x; }); }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    vector_t clamp(const vector_t& x, scalar_t<vector_t> low, scalar_t<vector_t> high) { return min(max(x, detail::splat<vector_t>(low)), detail::splat<vector_t>(high)); }
+
+    inline cl_float mix(cl_float x, cl_float y, cl_float a) { return x + (y - x) * a; }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    vector_t mix(const vector_t& x, const vector_t& y, scalar_t<vector_t> a) { return x + (y - x) * a; }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    scalar_t<vector_t> dot(const vector_t& a, const vector_t& b)
+    {
+        auto _dot = scalar_t<vector_t> { 0 };
+        for (std::size_t _k = 0; _k < vector_traits<vector_t>::lanes; ++_k) {
+            _dot += a.s[_k] * b.s[_k];
+        }
+        return _dot;
+    }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    cl_float length(const vector_t& a) { return std::sqrt(static_cast<cl_float>(dot(a, a))); }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    cl_float distance(const vector_t& a, const vector_t& b) { return length(a - b); }
+
+    template <typename vector_t, typename = std::enable_if_t<is_vector_v<vector_t>>>
+    vector_t normalize(const vector_t& a) { return a / length(a); }
+
+    inline cl_float4 cross(const cl_float4& a, const cl_float4& b)
+    {
+        auto _cross = cl_float4 {};
+        _cross.s[0] = a.s[1] * b.s[2] - a.s[2] * b.s[1];
+        _cross.s[1] = a.s[2] * b.s[0] - a.s[0] * b.s[2];
+        _cross.s[2] = a.s[0] * b.s[1] - a.s[1] * b.s[0];
+        return _cross;
+    }
+
+    template <typename value_t>
+    cl_float convert_float(value_t x) { return static_cast<cl_float>(x); }
+
+    template <typename value_t>
+    cl_int convert_int(value_t x) { return static_cast<cl_int>(x); }
+
+    template <typename value_t>
+    cl_uint convert_uint(value_t x) { return static_cast<cl_uint>(x); }
+
+    namespace detail {
+
+        template <typename value_t>
+        std::atomic<value_t>& as_atomic(volatile value_t* p)
+        {
+            static_assert(sizeof(std::atomic<value_t>) == sizeof(value_t) && std::atomic<value_t>::is_always_lock_free, "Atomic built-ins require lock-free 32-bit atomics");
+            return *reinterpret_cast<std::atomic<value_t>*>(const_cast<value_t*>(p));
+        }
+
+    }
+
+    template <typename value_t>
+    value_t atomic_add(volatile value_t* p, std::remove_cv_t<value_t> val) { return detail::as_atomic(p).fetch_add(val); }
+
+    template <typename value_t>
+    value_t atomic_sub(volatile value_t* p, std::remove_cv_t<value_t> val) { return detail::as_atomic(p).fetch_sub(val); }
+
+    template <typename value_t>
+    value_t atomic_inc(volatile value_t* p) { return detail::as_atomic(p).fetch_add(1); }
+
+    template <typename value_t>
+    value_t atomic_dec(volatile value_t* p) { return detail::as_atomic(p).fetch_sub(1); }
+
+    template <typename value_t>
+    value_t atomic_xchg(volatile value_t* p, std::remove_cv_t<value_t> val) { return detail::as_atomic(p).exchange(val); }
+
+    template <typename value_t>
+    value_t atomic_and(volatile value_t* p, std::remove_cv_t<value_t> val) { return detail::as_atomic(p).fetch_and(val); }
+
+    template <typename value_t>
+    value_t atomic_or(volatile value_t* p, std::remove_cv_t<value_t> val) { return detail::as_atomic(p).fetch_or(val); }
+
+    template <typename value_t>
+    value_t atomic_xor(volatile value_t* p, std::remove_cv_t<value_t> val) { return detail::as_atomic(p).fetch_xor(val); }
+
+    template <typename value_t>
+    value_t atomic_cmpxchg(volatile value_t* p, std::remove_cv_t<value_t> cmp, std::remove_cv_t<value_t> val)
+    {
+        detail::as_atomic(p).compare_exchange_strong(cmp, val);
+        return cmp;
+    }
+
+    template <typename value_t>
+    value_t atomic_min(volatile value_t* p, std::remove_cv_t<value_t> val)
+    {
+        auto& _atomic = detail::as_atomic(p);
+        auto _old = _atomic.load();
+        while (val < _old && !_atomic.compare_exchange_weak(_old, val)) { }
+        return _old;
+    }
+
+    template <typename value_t>
+    value_t atomic_max(volatile value_t* p, std::remove_cv_t<value_t> val)
+    {
+        auto& _atomic = detail::as_atomic(p);
+        auto _old = _atomic.load();
+        while (_old < val && !_atomic.compare_exchange_weak(_old, val)) { }
+        return _old;
+    }
+
+}
+
+}
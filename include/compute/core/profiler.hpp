@@ -0,0 +1,88 @@
+#pragma once
+
+#include <compute/core/opencl.hpp>
+
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace compute {
+
+/// @brief Device timestamps of a single command, as reported by OpenCL profiling.
+/// Timestamps are expressed in nanoseconds on the device clock.
+struct profiling_record {
+    std::string label;
+    std::string category;
+    std::size_t bytes;
+    cl_ulong queued;
+    cl_ulong submitted;
+    cl_ulong started;
+    cl_ulong ended;
+};
+
+/// @brief Aggregated timings of all the commands sharing the same label.
+/// Durations are measured between the start and end of execution on the device, in
+/// milliseconds. The bandwidth is the number of bytes moved divided by the total
+/// execution time, in gigabytes per second, and is zero for kernel dispatches.
+struct profiling_statistics {
+    std::size_t count;
+    double min_ms;
+    double mean_ms;
+    double p99_ms;
+    double total_ms;
+    std::size_t bytes;
+    double bandwidth_gbps;
+};
+
+/// @brief Collects device timings of the commands enqueued in a profiling-enabled context.
+/// A profiler is created by a `context` constructed with `CL_QUEUE_PROFILING_ENABLE`.
+/// Every transfer issued through `buffer` and `array_buffer` and every kernel dispatch
+/// issued through `kernel` is then recorded under the label of the object that issued it.
+/// Records are added from OpenCL completion callbacks; queries first wait for all the
+/// commands recorded so far to complete. Profilers are non-copyable and non-movable.
+struct profiler : std::enable_shared_from_this<profiler> {
+
+    profiler(const profiler& other) = delete;
+    profiler& operator=(const profiler& other) = delete;
+    profiler(profiler&& other) = delete;
+    profiler& operator=(profiler&& other) = delete;
+
+    /// @brief Constructs an empty profiler.
+    profiler();
+
+    /// @brief Returns every command recorded so far, in completion order.
+    /// @return A copy of the recorded commands.
+    [[nodiscard]] std::vector<profiling_record> get_records() const;
+
+    /// @brief Aggregates the timings of all the commands recorded under a label.
+    /// @param label The label given to the buffer or kernel that issued the commands.
+    /// @return The statistics, with a zero count if nothing was recorded under this label.
+    [[nodiscard]] profiling_statistics get_statistics(const std::string& label) const;
+
+    /// @brief Writes the recorded commands as a Chrome trace JSON file.
+    /// The file can be opened in `chrome://tracing` or Perfetto to inspect the device
+    /// timeline, with one track per command category.
+    /// Throws std::runtime_error if the file cannot be written.
+    /// @param path Path of the JSON file to write.
+    void dump_trace(const std::filesystem::path& path) const;
+
+    /// @brief Discards all the commands recorded so far.
+    void clear();
+
+private:
+    mutable std::mutex _mutex;
+    mutable std::condition_variable _completed;
+    std::size_t _pending;
+    std::vector<profiling_record> _records;
+    template <typename value_t> friend struct buffer;
+    template <typename value_t> friend struct array_buffer;
+    friend struct kernel;
+    void _track(cl_event evt, const std::string& label, const std::string& category, std::size_t bytes);
+    std::vector<profiling_record> _wait_records() const;
+    static void CL_CALLBACK _on_complete(cl_event evt, cl_int status, void* user_data);
+};
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <compute/core/opencl.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace compute {
+
+/// @brief Persistent on-disk cache of compiled OpenCL program binaries.
+/// When attached to a `context`, every `kernel` built in that context first looks for
+/// a binary matching its source, build options and device/driver identity, and reloads
+/// it with `clCreateProgramWithBinary` instead of compiling from source. Missing, stale
+/// or rejected binaries fall back to a regular build, whose result is then written back
+/// to the cache directory. The work-group sizes tuned by `kernel::run_tuned` are stored
+/// next to the binary of their program, so they are reused as long as the source, build
+/// options and device stay the same. Caches are non-copyable and non-movable, and can be
+/// shared between contexts.
+struct program_cache {
+
+    program_cache(const program_cache& other) = delete;
+    program_cache& operator=(const program_cache& other) = delete;
+    program_cache(program_cache&& other) = delete;
+    program_cache& operator=(program_cache&& other) = delete;
+
+    /// @brief Constructs a program cache storing binaries in a given directory.
+    /// The directory is created if it does not exist yet.
+    /// @param directory Path to the folder holding the cached program binaries.
+    program_cache(const std::filesystem::path& directory);
+
+    /// @brief Returns the directory where program binaries are stored.
+    /// @return The cache directory path.
+    [[nodiscard]] const std::filesystem::path& get_directory() const;
+
+    /// @brief Returns how many programs were successfully loaded from the cache.
+    /// @return The number of cache hits since construction.
+    [[nodiscard]] std::size_t get_hits() const;
+
+    /// @brief Returns how many programs had to be built from source.
+    /// This includes programs whose cached binary was missing, stale or rejected by the driver.
+    /// @return The number of cache misses since construction.
+    [[nodiscard]] std::size_t get_misses() const;
+
+private:
+    std::filesystem::path _directory;
+    std::atomic<std::size_t> _hits;
+    std::atomic<std::size_t> _misses;
+    friend struct kernel;
+    std::filesystem::path _get_path(const cl_device_id dev, const std::string& code, const std::string& options) const;
+    bool _load(const std::filesystem::path& path, std::vector<unsigned char>& binary) const;
+    void _store(const std::filesystem::path& path, const std::vector<unsigned char>& binary) const;
+    std::filesystem::path _get_work_groups_path(const std::filesystem::path& binary_path, const std::string& name) const;
+    void _load_work_groups(const std::filesystem::path& path, std::map<std::size_t, std::size_t>& local_sizes) const;
+    void _store_work_groups(const std::filesystem::path& path, const std::map<std::size_t, std::size_t>& local_sizes) const;
+};
+
+}
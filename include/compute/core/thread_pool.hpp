@@ -0,0 +1,73 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace compute {
+
+/// @brief Pool of host threads executing data-parallel loops.
+/// The `thread_pool` splits the range of a `parallel_for` into contiguous chunks, deals
+/// them out to one queue per thread, and lets threads that run out of work steal chunks
+/// from the other queues, so that uneven chunks do not leave cores idle. Chunk sizes are
+/// rounded to a multiple of the SIMD-friendly `chunk_alignment`, so that each thread runs
+/// tight loops over contiguous memory the compiler can vectorize. The calling thread takes
+/// part in the loop. Thread pools are non-copyable and non-movable, and join their
+/// threads on destruction.
+struct thread_pool {
+
+    thread_pool(const thread_pool& other) = delete;
+    thread_pool& operator=(const thread_pool& other) = delete;
+    thread_pool(thread_pool&& other) = delete;
+    thread_pool& operator=(thread_pool&& other) = delete;
+    ~thread_pool();
+
+    /// @brief Granularity, in iterations, of the chunks of a `parallel_for`.
+    static constexpr std::size_t chunk_alignment = 64;
+
+    /// @brief Starts the worker threads.
+    /// @param threads_count Number of threads running loops, including the calling
+    /// thread. Zero uses every hardware thread of the host.
+    explicit thread_pool(std::size_t threads_count = 0);
+
+    /// @brief Returns the number of threads running loops, including the calling thread.
+    [[nodiscard]] std::size_t get_threads_count() const;
+
+    /// @brief Runs a function over every iteration of a range, and waits for it to complete.
+    /// The function is called as `func(begin, end)` on disjoint chunks of `[0, count)`.
+    /// Rethrows the first exception thrown by the function, once every chunk has run.
+    /// Loops are serialized, and must not be started from inside a loop of the same pool.
+    /// @param count Number of iterations.
+    /// @param grain Minimum number of iterations of a chunk (rounded up to `chunk_alignment`).
+    /// @param func The function to invoke on every chunk.
+    void parallel_for(std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& func);
+
+private:
+    struct chunk_queue {
+        std::mutex mutex;
+        std::deque<std::pair<std::size_t, std::size_t>> chunks;
+    };
+    std::vector<std::thread> _threads;
+    std::vector<std::unique_ptr<chunk_queue>> _queues;
+    std::mutex _loop_mutex;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    const std::function<void(std::size_t, std::size_t)>* _func;
+    std::size_t _generation;
+    std::size_t _remaining;
+    std::exception_ptr _exception;
+    bool _stopping;
+    void _work(std::size_t idx);
+    void _run_chunks(std::size_t idx);
+    bool _pop_chunk(std::size_t idx, std::pair<std::size_t, std::size_t>& chunk);
+};
+
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <compute/ecs/component_storage.hpp>
+
+#include <type_traits>
+#include <vector>
+
+namespace compute {
+
+/// @brief Declares that a system only reads a component type.
+/// Used in the component list of `registry::execute_system` and `pipeline::add`, as in
+/// `execute_system<gravity, read<mass>, write<velocity>>`. Equivalent to `const component_t`.
+/// @tparam component_t The component type read by the system.
+template <typename component_t>
+struct read {
+    using type = component_t;
+};
+
+/// @brief Declares that a system reads and writes a component type.
+/// This is the default access of component types listed without annotation.
+/// @tparam component_t The component type written by the system.
+template <typename component_t>
+struct write {
+    using type = component_t;
+};
+
+/// @brief Resolves the component type and access of an entry of a system component list.
+/// Entries can be a plain component type, a `const` qualified one, `read<component_t>`
+/// or `write<component_t>`.
+/// @tparam access_t The entry of the component list.
+template <typename access_t>
+struct component_access_traits {
+    using type = std::remove_const_t<access_t>;
+    static constexpr bool read_only = std::is_const_v<access_t>;
+};
+
+template <typename component_t>
+struct component_access_traits<read<component_t>> {
+    using type = std::remove_const_t<component_t>;
+    static constexpr bool read_only = true;
+};
+
+template <typename component_t>
+struct component_access_traits<write<component_t>> {
+    using type = std::remove_const_t<component_t>;
+    static constexpr bool read_only = false;
+};
+
+template <typename access_t>
+using component_type_t = typename component_access_traits<access_t>::type;
+
+/// @brief Detects systems generated by systemc with parameter access information.
+/// Such systems declare `read_only_args`, holding whether each parameter of the kernel
+/// signature is a pointer to `const` data.
+/// @tparam system_t The system type to inspect.
+template <typename system_t, typename = void>
+struct has_read_only_args : std::false_type { };
+
+template <typename system_t>
+struct has_read_only_args<system_t, std::void_t<decltype(system_t::read_only_args)>> : std::true_type { };
+
+/// @brief Detects systems generated by systemc with a bounds guard.
+/// The kernel of such systems takes the number of work-items as a trailing `uint`
+/// parameter and ignores the work-items past it, so their global size can be padded
+/// up to a multiple of the tuned work-group size.
+/// @tparam system_t The system type to inspect.
+template <typename system_t, typename = void>
+struct has_bounds_guard : std::false_type { };
+
+template <typename system_t>
+struct has_bounds_guard<system_t, std::void_t<decltype(system_t::bounds_guard)>> : std::bool_constant<system_t::bounds_guard> { };
+
+namespace detail {
+
+    /// @brief Returns whether a system only reads each of its components.
+    /// A component is read-only when it is annotated as such in the component list, or
+    /// when all the kernel parameters it is bound to are declared `const`. Kernel
+    /// signatures are only used when their parameter count matches the bound columns
+    /// followed by the uniform values.
+    /// @param uniforms_count Number of uniform values bound after the component columns.
+    template <typename system_t, typename... access_t>
+    std::vector<bool> get_read_only_components(std::size_t uniforms_count = 0)
+    {
+        auto _read_only = std::vector<bool> { component_access_traits<access_t>::read_only... };
+        if constexpr (has_read_only_args<system_t>::value) {
+            const auto& _args = system_t::read_only_args;
+            auto _columns = std::vector<std::size_t> { component_storage<component_type_t<access_t>>::columns_count... };
+            auto _total = std::size_t { 0 };
+            for (const auto _count : _columns) {
+                _total += _count;
+            }
+            if (_total + uniforms_count == _args.size()) {
+                auto _arg = std::size_t { 0 };
+                for (std::size_t _k = 0; _k < _columns.size(); ++_k) {
+                    auto _const = true;
+                    for (std::size_t _j = 0; _j < _columns[_k]; ++_j) {
+                        _const = _const && _args[_arg++];
+                    }
+                    _read_only[_k] = _read_only[_k] || _const;
+                }
+            }
+        }
+        return _read_only;
+    }
+
+}
+
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <compute/core/buffer.hpp>
+#include <compute/core/context.hpp>
+#include <compute/core/kernel.hpp>
+#include <compute/ecs/access.hpp>
+#include <compute/ecs/component_storage.hpp>
+#include <compute/ecs/entity.hpp>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace compute {
+
+/// @brief Archetype-based alternative to `registry` for scenes with many sparse component types.
+/// Entities sharing the same set of component types (their archetype) are packed together
+/// into fixed-size device chunks holding one `component_storage<component_t>` per component type.
+/// Systems are dispatched once per chunk of every archetype containing their components,
+/// so iteration is fully dense, with no holes and no indirection. Device memory only grows
+/// with the component combinations actually used, instead of `capacity` elements per
+/// component type. Adding a component moves the entity to another archetype, copying its
+/// other components on the device.
+/// @note Like `registry`, the archetype registry does not store component values on the host.
+struct archetype_registry {
+
+    archetype_registry(const archetype_registry& other) = delete;
+    archetype_registry& operator=(const archetype_registry& other) = delete;
+    archetype_registry(archetype_registry&& other) noexcept = default;
+    archetype_registry& operator=(archetype_registry&& other) noexcept = default;
+
+    /// @brief Constructs a new archetype registry backed by a given GPU context.
+    /// @param ctx The device context used for all memory allocations and kernel launches.
+    /// @param chunk_capacity Number of entities stored in each device chunk (default: 1024).
+    /// @param options Build options used when compiling system kernels (can be empty).
+    archetype_registry(const context& ctx, std::size_t chunk_capacity = 1024, const std::string& options = "");
+
+    /// @brief Creates a new entity.
+    /// The entity initially has no components and does not belong to any archetype.
+    /// @return A unique entity handle.
+    [[nodiscard]] entity create_entity();
+
+    /// @brief Adds a component to the given entity.
+    /// The entity is moved to the archetype matching its new set of components.
+    /// Throws std::runtime_error if the entity already has this component.
+    /// @tparam component_t The type of component being added.
+    /// @param e The target entity.
+    /// @param value The value to assign to this entity’s component.
+    template <typename component_t>
+    future<void> add_component(entity e, const component_t& value);
+
+    /// @brief Asynchronously retrieves a component's value from the device.
+    /// @tparam component_t The component type to fetch.
+    /// @param e The entity whose component should be fetched.
+    /// @return A future resolving to the component value.
+    template <typename component_t>
+    [[nodiscard]] future<component_t> get_component(entity e);
+
+    /// @brief Executes a user-defined system over the specified component types.
+    /// The system kernel is dispatched once per non-empty chunk of every archetype
+    /// containing all the requested components, with global work size equal to the
+    /// number of entities in the chunk. Components can be listed as `read<component_t>`
+    /// or `write<component_t>`; systems always write chunk columns in place.
+    /// Uniform values are bound by value after the component columns, in order.
+    /// @param uniforms Trivially copyable values matching the trailing kernel parameters.
+    template <typename system_t, typename... components_t, typename... uniforms_t>
+    future<void> execute_system(const uniforms_t&... uniforms);
+
+    /// @brief Compiles and caches the kernel of a user-defined system ahead of time.
+    /// @tparam system_t The generated system type to compile.
+    template <typename system_t>
+    void compile_system();
+
+    /// @brief Returns the number of archetypes created so far.
+    /// @return The number of distinct component combinations in use.
+    [[nodiscard]] std::size_t get_archetypes_count() const;
+
+private:
+    struct component_type {
+        std::function<std::shared_ptr<void>(std::size_t)> create;
+        std::function<void(void*, const void*, std::size_t, std::size_t)> copy;
+    };
+    struct chunk {
+        std::unordered_map<std::type_index, std::shared_ptr<void>> columns;
+        std::vector<entity> entities;
+    };
+    struct archetype {
+        std::vector<std::type_index> signature;
+        std::vector<chunk> chunks;
+    };
+    struct location {
+        archetype* arch;
+        std::size_t chunk;
+        std::size_t row;
+    };
+    struct archetype_query {
+        std::size_t version = 0;
+        std::vector<archetype*> archetypes;
+    };
+    const context& _context;
+    std::size_t _chunk_capacity;
+    std::uint32_t _next_entity;
+    std::string _build_options;
+    std::unordered_map<std::type_index, component_type> _component_types;
+    std::map<std::vector<std::type_index>, archetype> _archetypes;
+    std::unordered_map<entity, location> _locations;
+    std::map<std::vector<std::type_index>, archetype_query> _queries;
+    std::map<std::type_index, std::shared_ptr<compute::kernel>> _system_kernels;
+    template <typename component_t>
+    void _register_component_type();
+    location _move_entity(entity e, const std::type_index& added);
+    void _remove_row(archetype& arch, std::size_t chunk_idx, std::size_t row);
+    const std::vector<archetype*>& _get_matching_archetypes(std::vector<std::type_index> types);
+};
+
+}
+
+#include "archetype_registry.inl"
@@ -0,0 +1,86 @@
+namespace compute {
+
+template <typename component_t>
+future<void> archetype_registry::add_component(entity e, const component_t& value)
+{
+    _register_component_type<component_t>();
+    auto _location = _move_entity(e, std::type_index(typeid(component_t)));
+    auto& _column = _location.arch->chunks[_location.chunk].columns.at(std::type_index(typeid(component_t)));
+    return std::static_pointer_cast<compute::component_storage<component_t>>(_column)->set(_location.row, value);
+}
+
+template <typename component_t>
+future<component_t> archetype_registry::get_component(entity e)
+{
+    auto _it = _locations.find(e);
+    if (_it == _locations.end()) {
+        throw std::runtime_error("Component not found for entity");
+    }
+    const auto& _columns = _it->second.arch->chunks[_it->second.chunk].columns;
+    auto _column = _columns.find(std::type_index(typeid(component_t)));
+    if (_column == _columns.end()) {
+        throw std::runtime_error("Component not found for entity");
+    }
+    return std::static_pointer_cast<compute::component_storage<component_t>>(_column->second)->fetch(_it->second.row);
+}
+
+template <typename system_t, typename... components_t, typename... uniforms_t>
+future<void> archetype_registry::execute_system(const uniforms_t&... uniforms)
+{
+    static_assert(sizeof...(components_t) > 0, "Archetype systems require at least one component");
+    compile_system<system_t>();
+    auto _krn = _system_kernels.at(std::type_index(typeid(system_t)));
+    auto _result = detail::make_ready_future();
+    for (auto* _archetype : _get_matching_archetypes({ std::type_index(typeid(component_type_t<components_t>))... })) {
+        for (auto& _chunk : _archetype->chunks) {
+            if (_chunk.entities.empty()) {
+                continue;
+            }
+            auto _arg = std::size_t { 0 };
+            (std::static_pointer_cast<compute::component_storage<component_type_t<components_t>>>(_chunk.columns.at(std::type_index(typeid(component_type_t<components_t>))))->bind(*_krn, _arg), ...);
+            (_krn->set_arg(_arg++, uniforms), ...);
+            if constexpr (has_bounds_guard<system_t>::value) {
+                _krn->set_arg(_arg, static_cast<cl_uint>(_chunk.entities.size()));
+                _result = _krn->run_tuned(_chunk.entities.size());
+            } else {
+                _result = _krn->run({ _chunk.entities.size() });
+            }
+        }
+    }
+    return _result;
+}
+
+template <typename system_t>
+void archetype_registry::compile_system()
+{
+    auto _type = std::type_index(typeid(system_t));
+    if (_system_kernels.find(_type) == _system_kernels.end()) {
+        auto _krn = std::make_shared<compute::kernel>(_context, system_t::kernel_source, "smain", _build_options);
+        _krn->set_label(typeid(system_t).name());
+        _system_kernels.emplace(_type, _krn);
+    }
+}
+
+template <typename component_t>
+void archetype_registry::_register_component_type()
+{
+    auto _type = std::type_index(typeid(component_t));
+    if (_component_types.find(_type) != _component_types.end()) {
+        return;
+    }
+    check_component_layout<component_t>(_context);
+    auto _component_type = component_type {};
+    _component_type.create = [&ctx = _context](std::size_t capacity) {
+        auto _column = std::make_shared<compute::component_storage<component_t>>(ctx, capacity);
+        _column->set_label(typeid(component_t).name());
+        return std::static_pointer_cast<void>(_column);
+    };
+    _component_type.copy = [](void* dst, const void* src, std::size_t src_row, std::size_t dst_row) {
+        auto* _dst = static_cast<compute::component_storage<component_t>*>(dst);
+        const auto* _src = static_cast<const compute::component_storage<component_t>*>(src);
+        _dst->copy(*_src, src_row, dst_row, 1);
+    };
+    _component_types.emplace(_type, std::move(_component_type));
+}
+
+}
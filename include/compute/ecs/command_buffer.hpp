@@ -0,0 +1,92 @@
+#pragma once
+
+#include <compute/ecs/registry.hpp>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <typeindex>
+#include <vector>
+
+namespace compute {
+
+/// @brief Deferred list of structural changes to apply to a registry at once.
+/// The `command_buffer` records component additions, updates and removals as well as
+/// entity destructions on the host, without touching the device. `registry::apply`
+/// then sorts them by component type and uploads every batch with a few coalesced
+/// writes and one scatter kernel per component store, so that applying thousands of
+/// edits costs a constant number of enqueues. Entities are created immediately, since
+/// creating an entity only reserves a handle on the host. Command buffers are
+/// non-copyable but movable, and are emptied once applied.
+struct command_buffer {
+
+    command_buffer(const command_buffer& other) = delete;
+    command_buffer& operator=(const command_buffer& other) = delete;
+    command_buffer(command_buffer&& other) noexcept = default;
+    command_buffer& operator=(command_buffer&& other) noexcept = default;
+
+    /// @brief Constructs an empty command buffer recording changes for a registry.
+    /// @param reg The registry the commands will be applied to. It must outlive the buffer.
+    explicit command_buffer(registry& reg);
+
+    /// @brief Creates a new entity in the registry.
+    /// The handle is valid immediately, so that components can be recorded for it.
+    /// @return A unique entity handle.
+    [[nodiscard]] entity create_entity();
+
+    /// @brief Records the destruction of an entity and the removal of all its components.
+    /// Destructions are applied after every other command of the buffer.
+    /// @param e The entity to destroy.
+    void destroy_entity(entity e);
+
+    /// @brief Records the addition of a component to an entity.
+    /// @tparam component_t The type of component being added.
+    /// @param e The target entity.
+    /// @param value The value to assign to this entity's component.
+    template <typename component_t>
+    void add_component(entity e, const component_t& value);
+
+    /// @brief Records a new value for a component of an entity.
+    /// Updates are applied after the additions of the buffer, so the component can be
+    /// added in the same buffer. When the same component of an entity is set several
+    /// times, the last value wins.
+    /// @tparam component_t The type of component being updated.
+    /// @param e The target entity.
+    /// @param value The new value of this entity's component.
+    template <typename component_t>
+    void set_component(entity e, const component_t& value);
+
+    /// @brief Records the removal of a component from an entity.
+    /// Removals are applied before the additions and updates of the buffer.
+    /// @tparam component_t The type of component being removed.
+    /// @param e The target entity.
+    template <typename component_t>
+    void remove_component(entity e);
+
+    /// @brief Returns the number of recorded commands.
+    /// @return The number of commands applied by the next `registry::apply`.
+    [[nodiscard]] std::size_t get_size() const;
+
+    /// @brief Discards every recorded command.
+    void clear();
+
+private:
+    struct component_commands {
+        std::vector<entity> adds;
+        std::vector<entity> sets;
+        std::vector<entity> removes;
+        std::shared_ptr<void> add_values;
+        std::shared_ptr<void> set_values;
+        std::function<future<void>(registry&, component_commands&)> apply;
+    };
+    registry* _registry;
+    std::map<std::type_index, component_commands> _commands;
+    std::vector<entity> _destroyed;
+    friend struct registry;
+    template <typename component_t>
+    component_commands& _get_or_create_commands();
+};
+
+}
+
+#include "command_buffer.inl"
@@ -0,0 +1,48 @@
+namespace compute {
+
+template <typename component_t>
+void command_buffer::add_component(entity e, const component_t& value)
+{
+    auto& _cmds = _get_or_create_commands<component_t>();
+    _cmds.adds.push_back(e);
+    std::static_pointer_cast<std::vector<component_t>>(_cmds.add_values)->push_back(value);
+}
+
+template <typename component_t>
+void command_buffer::set_component(entity e, const component_t& value)
+{
+    auto& _cmds = _get_or_create_commands<component_t>();
+    _cmds.sets.push_back(e);
+    std::static_pointer_cast<std::vector<component_t>>(_cmds.set_values)->push_back(value);
+}
+
+template <typename component_t>
+void command_buffer::remove_component(entity e)
+{
+    _get_or_create_commands<component_t>().removes.push_back(e);
+}
+
+template <typename component_t>
+command_buffer::component_commands& command_buffer::_get_or_create_commands()
+{
+    auto _type = std::type_index(typeid(component_t));
+    auto _it = _commands.find(_type);
+    if (_it != _commands.end()) {
+        return _it->second;
+    }
+    auto _cmds = component_commands {};
+    _cmds.add_values = std::make_shared<std::vector<component_t>>();
+    _cmds.set_values = std::make_shared<std::vector<component_t>>();
+    _cmds.apply = [](registry& reg, component_commands& cmds) {
+        auto& _add_values = *std::static_pointer_cast<std::vector<component_t>>(cmds.add_values);
+        auto& _set_values = *std::static_pointer_cast<std::vector<component_t>>(cmds.set_values);
+        auto _result = reg._add_components<component_t>(cmds.adds, std::move(_add_values));
+        if (!cmds.sets.empty()) {
+            _result = reg._set_components<component_t>(cmds.sets, std::move(_set_values));
+        }
+        return _result;
+    };
+    return _commands.emplace(_type, std::move(_cmds)).first->second;
+}
+
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <compute/core/buffer.hpp>
+#include <compute/core/context.hpp>
+#include <compute/core/kernel.hpp>
+
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace compute {
+
+/// @brief Detects components generated by componentc with `"layout": "soa"`.
+/// Such components declare their field types as `field_types` and expose their
+/// fields as a tuple of references through `as_tuple()`.
+/// @tparam component_t The component type to inspect.
+template <typename component_t, typename = void>
+struct is_soa_component : std::false_type { };
+
+template <typename component_t>
+struct is_soa_component<component_t, std::void_t<typename component_t::field_types>> : std::true_type { };
+
+template <typename component_t>
+inline constexpr bool is_soa_component_v = is_soa_component<component_t>::value;
+
+/// @brief Detects components generated by componentc with a device layout probe.
+/// Such components declare their expected size and field offsets as `layout`, and the
+/// OpenCL C source of a `clecs_layout` kernel measuring them on the device as `layout_probe`.
+/// @tparam component_t The component type to inspect.
+template <typename component_t, typename = void>
+struct has_layout_probe : std::false_type { };
+
+template <typename component_t>
+struct has_layout_probe<component_t, std::void_t<decltype(component_t::layout_probe)>> : std::true_type { };
+
+template <typename component_t>
+inline constexpr bool has_layout_probe_v = has_layout_probe<component_t>::value;
+
+/// @brief Checks that the device lays out a component exactly like the host compiler.
+/// Runs the generated layout probe once and compares the measured size and field offsets
+/// with the ones the host struct was generated for. Components without a probe are
+/// accepted as is. Throws std::runtime_error if the layouts differ, since bulk copies
+/// between host and device would then silently corrupt the component values.
+/// @tparam component_t The component type to check.
+/// @param ctx The context of the device to check the layout on.
+template <typename component_t>
+void check_component_layout(const context& ctx);
+
+namespace detail {
+
+    template <typename component_t, bool soa_v = is_soa_component_v<component_t>>
+    struct component_columns {
+        using types = std::tuple<component_t>;
+        static auto tie(component_t& value) { return std::tie(value); }
+        static auto tie(const component_t& value) { return std::tie(value); }
+    };
+
+    template <typename component_t>
+    struct component_columns<component_t, true> {
+        using types = typename component_t::field_types;
+        static auto tie(component_t& value) { return value.as_tuple(); }
+        static auto tie(const component_t& value) { return value.as_tuple(); }
+    };
+
+    template <typename types_t>
+    struct column_buffers;
+
+    template <typename... columns_t>
+    struct column_buffers<std::tuple<columns_t...>> {
+        using type = std::tuple<array_buffer<columns_t>...>;
+        using futures = std::tuple<future<columns_t>...>;
+        using vectors = std::tuple<std::vector<columns_t>...>;
+        static type create(const context& ctx, std::size_t sz, cl_mem_flags flags) { return type(array_buffer<columns_t>(ctx, sz, flags)...); }
+    };
+
+}
+
+/// @brief Device storage for all the values of one component type.
+/// Components using the default array-of-structs layout are stored in a single
+/// `array_buffer<component_t>`. Components generated with `"layout": "soa"` are stored
+/// with one `array_buffer` per field, so that kernels touching only some fields read
+/// contiguous, coalesced memory. Both layouts expose the same element-wise interface;
+/// operations on several columns are chained on the device through wait lists.
+/// Component storages are non-copyable but movable.
+/// @tparam component_t The component type stored.
+template <typename component_t>
+struct component_storage {
+
+    using column_types = typename detail::component_columns<component_t>::types;
+    static constexpr std::size_t columns_count = std::tuple_size_v<column_types>;
+
+    component_storage(const component_storage& other) = delete;
+    component_storage& operator=(const component_storage& other) = delete;
+    component_storage(component_storage&& other) noexcept = default;
+    component_storage& operator=(component_storage&& other) noexcept = default;
+
+    /// @brief Constructs a storage with an initial number of elements.
+    /// @param ctx The compute context the columns will reside in.
+    /// @param sz Number of elements to allocate in every column.
+    /// @param flags OpenCL memory flags of every column (default: `CL_MEM_READ_WRITE`).
+    component_storage(const context& ctx, std::size_t sz, cl_mem_flags flags = CL_MEM_READ_WRITE);
+
+    /// @brief Sets a single component value, splitting it across the columns.
+    /// Throws std::out_of_range exception if index is greater than the storage size.
+    /// @param idx Index of the element to update.
+    /// @param val The new component value.
+    /// @param wait_list Events that must complete before the transfers start.
+    future<void> set(std::size_t idx, const component_t& val, const std::vector<event>& wait_list = {});
+
+    /// @brief Sets a contiguous range of component values.
+    /// Throws std::out_of_range exception if the range exceeds the storage size.
+    /// @param offset Index of the first element to update.
+    /// @param vals The component values to write starting at `offset`.
+    /// @param wait_list Events that must complete before the transfers start.
+    future<void> set(std::size_t offset, const std::vector<component_t>& vals, const std::vector<event>& wait_list = {});
+
+    /// @brief Copies a range of component values from another storage, entirely on the device.
+    /// Throws std::out_of_range exception if either range exceeds its storage size.
+    /// @param src The storage to copy elements from (can be this storage).
+    /// @param src_offset Index of the first element to copy in `src`.
+    /// @param dst_offset Index of the first element to overwrite in this storage.
+    /// @param count Number of elements to copy.
+    /// @param wait_list Events that must complete before the copies start.
+    future<void> copy(const component_storage& src, std::size_t src_offset, std::size_t dst_offset, std::size_t count, const std::vector<event>& wait_list = {});
+
+    /// @brief Asynchronously fetches a single component value, joining its columns.
+    /// Throws std::out_of_range exception if index is greater than the storage size.
+    /// @param idx Index of the element to fetch.
+    /// @param wait_list Events that must complete before the transfers start.
+    /// @return A future resolving to the component value.
+    [[nodiscard]] future<component_t> fetch(std::size_t idx, const std::vector<event>& wait_list = {});
+
+    /// @brief Asynchronously fetches a contiguous range of component values.
+    /// Every column is read straight into host vectors, and SoA values are joined lazily
+    /// by the thread calling get().
+    /// Throws std::out_of_range exception if the range exceeds the storage size.
+    /// @param offset Index of the first element to fetch.
+    /// @param count Number of elements to fetch.
+    /// @param wait_list Events that must complete before the transfers start.
+    /// @return A future resolving to the component values.
+    [[nodiscard]] future<std::vector<component_t>> fetch_range(std::size_t offset, std::size_t count, const std::vector<event>& wait_list = {});
+
+    /// @brief Changes the number of elements in every column.
+    /// @param sz The new number of elements.
+    /// @param wait_list Events that must complete before the copies start.
+    /// @return A future resolving once the columns have been reallocated.
+    future<void> resize(std::size_t sz, const std::vector<event>& wait_list = {});
+
+    /// @brief Returns the number of elements in the storage.
+    [[nodiscard]] std::size_t get_size() const;
+
+    /// @brief Names the commands issued by every column in the context profiler.
+    /// @param label The label under which transfers are recorded.
+    void set_label(const std::string& label);
+
+    /// @brief Binds every column as consecutive kernel arguments.
+    /// @param krn The kernel to bind the columns to.
+    /// @param idx Index of the first argument, advanced past the last bound column.
+    void bind(kernel& krn, std::size_t& idx);
+
+    /// @brief Invokes a function on every pair of matching columns of two storages.
+    /// @param other The other storage of the same component type.
+    /// @param func Function called as `func(column, other_column)` for every column.
+    template <typename function_t>
+    void for_each_column(component_storage& other, function_t&& func);
+
+private:
+    typename detail::column_buffers<column_types>::type _columns;
+    template <typename function_t>
+    future<void> _chain(const std::vector<event>& wait_list, function_t&& enqueue);
+    template <typename function_t, std::size_t... indices_v>
+    future<void> _chain(const std::vector<event>& wait_list, function_t& enqueue, std::index_sequence<indices_v...>);
+};
+
+}
+
+#include "component_storage.inl"
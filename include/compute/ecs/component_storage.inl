@@ -0,0 +1,169 @@
+namespace compute {
+
+template <typename component_t>
+void check_component_layout(const context& ctx)
+{
+    if constexpr (has_layout_probe_v<component_t>) {
+        auto _krn = kernel(ctx, component_t::layout_probe, "clecs_layout");
+        auto _layout = array_buffer<cl_uint>(ctx, component_t::layout.size());
+        _krn.set_arg(0, _layout);
+        auto _probed = _krn.run({ 1 });
+        auto _device_layout = _layout.fetch({ _probed.get_event() }).get();
+        if (!std::equal(_device_layout.begin(), _device_layout.end(), component_t::layout.begin())) {
+            throw std::runtime_error(std::string("Component layout differs between host and device: ") + typeid(component_t).name());
+        }
+    }
+}
+
+template <typename component_t>
+component_storage<component_t>::component_storage(const context& ctx, std::size_t sz, cl_mem_flags flags)
+    : _columns(detail::column_buffers<column_types>::create(ctx, sz, flags))
+{
+}
+
+template <typename component_t>
+future<void> component_storage<component_t>::set(std::size_t idx, const component_t& val, const std::vector<event>& wait_list)
+{
+    auto _values = detail::component_columns<component_t>::tie(val);
+    return _chain(wait_list, [&](auto column_idx, const std::vector<event>& waits) {
+        return std::get<column_idx>(_columns).set(idx, std::get<column_idx>(_values), waits);
+    });
+}
+
+template <typename component_t>
+future<void> component_storage<component_t>::set(std::size_t offset, const std::vector<component_t>& vals, const std::vector<event>& wait_list)
+{
+    if constexpr (!is_soa_component_v<component_t>) {
+        return std::get<0>(_columns).set(offset, vals, wait_list);
+    } else {
+        return _chain(wait_list, [&](auto column_idx, const std::vector<event>& waits) {
+            using column_t = std::tuple_element_t<column_idx, column_types>;
+            auto _column = std::vector<column_t>(vals.size());
+            for (std::size_t _k = 0; _k < vals.size(); ++_k) {
+                _column[_k] = std::get<column_idx>(detail::component_columns<component_t>::tie(vals[_k]));
+            }
+            return std::get<column_idx>(_columns).set(offset, std::move(_column), waits);
+        });
+    }
+}
+
+template <typename component_t>
+future<void> component_storage<component_t>::copy(const component_storage& src, std::size_t src_offset, std::size_t dst_offset, std::size_t count, const std::vector<event>& wait_list)
+{
+    return _chain(wait_list, [&](auto column_idx, const std::vector<event>& waits) {
+        return std::get<column_idx>(_columns).copy(std::get<column_idx>(src._columns), src_offset, dst_offset, count, waits);
+    });
+}
+
+template <typename component_t>
+future<component_t> component_storage<component_t>::fetch(std::size_t idx, const std::vector<event>& wait_list)
+{
+    if constexpr (!is_soa_component_v<component_t>) {
+        return std::get<0>(_columns).fetch(idx, wait_list);
+    } else {
+        // every column read waits for the previous one, so the last event covers them all;
+        // the value is joined lazily by the thread calling get(), never in a callback
+        auto _fetched = std::apply([&](auto&... columns) {
+            auto _waits = wait_list;
+            auto _fetch = [&](auto& column) {
+                auto _future = column.fetch(idx, _waits);
+                _waits = { _future.get_event() };
+                return _future;
+            };
+            using futures_t = typename detail::column_buffers<column_types>::futures;
+            return std::make_shared<futures_t>(futures_t { _fetch(columns)... });
+        }, _columns);
+        auto _last = std::get<columns_count - 1>(*_fetched).get_event();
+        auto _joined = std::async(std::launch::deferred, [_fetched]() {
+            auto _value = component_t {};
+            detail::component_columns<component_t>::tie(_value) = std::apply([](auto&... futures) { return std::make_tuple(futures.get()...); }, *_fetched);
+            return _value;
+        });
+        return future<component_t>(std::move(_joined), _last);
+    }
+}
+
+template <typename component_t>
+future<std::vector<component_t>> component_storage<component_t>::fetch_range(std::size_t offset, std::size_t count, const std::vector<event>& wait_list)
+{
+    if (offset + count > get_size()) {
+        throw std::out_of_range("Fetch range exceeds storage size");
+    }
+    auto _host = std::make_shared<typename detail::column_buffers<column_types>::vectors>();
+    auto _fetched = std::make_shared<future<void>>(_chain(wait_list, [&](auto column_idx, const std::vector<event>& waits) {
+        auto& _values = std::get<column_idx>(*_host);
+        _values.resize(count);
+        return std::get<column_idx>(_columns).fetch(_values.data(), offset, count, waits);
+    }));
+    auto _last = _fetched->get_event();
+    auto _joined = std::async(std::launch::deferred, [_host, _fetched, count]() {
+        _fetched->get();
+        if constexpr (!is_soa_component_v<component_t>) {
+            return std::move(std::get<0>(*_host));
+        } else {
+            auto _values = std::vector<component_t>(count);
+            std::apply([&](auto&... columns) {
+                for (std::size_t _k = 0; _k < count; ++_k) {
+                    detail::component_columns<component_t>::tie(_values[_k]) = std::tie(columns[_k]...);
+                }
+            }, *_host);
+            return _values;
+        }
+    });
+    return future<std::vector<component_t>>(std::move(_joined), _last);
+}
+
+template <typename component_t>
+future<void> component_storage<component_t>::resize(std::size_t sz, const std::vector<event>& wait_list)
+{
+    return _chain(wait_list, [&](auto column_idx, const std::vector<event>& waits) {
+        return std::get<column_idx>(_columns).resize(sz, waits);
+    });
+}
+
+template <typename component_t>
+std::size_t component_storage<component_t>::get_size() const
+{
+    return std::get<0>(_columns).get_size();
+}
+
+template <typename component_t>
+void component_storage<component_t>::set_label(const std::string& label)
+{
+    std::apply([&](auto&... columns) { (columns.set_label(label), ...); }, _columns);
+}
+
+template <typename component_t>
+void component_storage<component_t>::bind(kernel& krn, std::size_t& idx)
+{
+    std::apply([&](auto&... columns) { (krn.set_arg(idx++, columns), ...); }, _columns);
+}
+
+template <typename component_t>
+template <typename function_t>
+void component_storage<component_t>::for_each_column(component_storage& other, function_t&& func)
+{
+    _chain({}, [&](auto column_idx, const std::vector<event>&) {
+        func(std::get<column_idx>(_columns), std::get<column_idx>(other._columns));
+        return detail::make_ready_future();
+    });
+}
+
+template <typename component_t>
+template <typename function_t>
+future<void> component_storage<component_t>::_chain(const std::vector<event>& wait_list, function_t&& enqueue)
+{
+    return _chain(wait_list, enqueue, std::make_index_sequence<columns_count> {});
+}
+
+template <typename component_t>
+template <typename function_t, std::size_t... indices_v>
+future<void> component_storage<component_t>::_chain(const std::vector<event>& wait_list, function_t& enqueue, std::index_sequence<indices_v...>)
+{
+    auto _result = detail::make_ready_future();
+    auto _waits = wait_list;
+    ((_result = enqueue(std::integral_constant<std::size_t, indices_v> {}, _waits), _waits = { _result.get_event() }), ...);
+    return _result;
+}
+
+}
@@ -5,8 +5,36 @@
 namespace compute {
 
 /// @brief Unique identifier for an entity in the ECS.
-/// Entities are represented as 32-bit unsigned integers. They act as handles
-/// that associate component data stored in device memory via ECS buffers.
-using entity = std::uint32_t;
+/// Entities are represented as 64-bit generational handles. They act as handles
+/// that associate component data stored in device memory via ECS buffers. The low
+/// 32 bits hold the entity index, which is recycled once the entity is destroyed,
+/// and the high 32 bits hold the version of that index, so that handles to
+/// destroyed entities can be told apart from handles to their successors.
+using entity = std::uint64_t;
+
+/// @brief Builds an entity handle from an index and a version.
+/// @param index Index of the entity in the registry.
+/// @param version Number of times this index has been recycled.
+/// @return The corresponding entity handle.
+[[nodiscard]] constexpr entity make_entity(std::uint32_t index, std::uint32_t version)
+{
+    return (static_cast<entity>(version) << 32) | static_cast<entity>(index);
+}
+
+/// @brief Returns the index part of an entity handle.
+/// @param e The entity handle.
+/// @return The index of the entity in the registry.
+[[nodiscard]] constexpr std::uint32_t get_entity_index(entity e)
+{
+    return static_cast<std::uint32_t>(e & 0xffffffffu);
+}
+
+/// @brief Returns the version part of an entity handle.
+/// @param e The entity handle.
+/// @return The number of times the entity index had been recycled when the handle was created.
+[[nodiscard]] constexpr std::uint32_t get_entity_version(entity e)
+{
+    return static_cast<std::uint32_t>(e >> 32);
+}
 
 }
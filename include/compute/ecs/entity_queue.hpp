@@ -0,0 +1,129 @@
+#pragma once
+
+#include <compute/core/buffer.hpp>
+#include <compute/core/context.hpp>
+#include <compute/core/kernel.hpp>
+#include <compute/ecs/component_storage.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+
+namespace compute {
+
+/// @brief Requests the entity index of every component a system processes.
+/// Passed after the components of `registry::execute_system` or `pipeline::add`, it binds
+/// a `__global const uint*` argument (`clecs_entity_ids(var)` in kernels) holding the index
+/// of the entity processed by each work item, so that systems can push it to a
+/// `destroy_queue`.
+struct entity_ids { };
+
+/// @brief Device-side append queue of entities to create.
+/// Systems receive the queue as a counter and capacity (`clecs_queue_params(var)`) followed
+/// by the columns of every component type, and reserve an element with `clecs_reserve(var)`
+/// before writing its components. `registry::reconcile` then creates one entity per
+/// reserved element and copies its components into the component stores entirely on the
+/// device. Requests beyond the capacity are dropped. Spawn queues are non-copyable but
+/// movable, and are passed to pipelines with `std::ref`.
+/// @tparam components_t The component types of every spawned entity.
+template <typename... components_t>
+struct spawn_queue {
+
+    static_assert(sizeof...(components_t) > 0, "Spawn queues require at least one component");
+
+    spawn_queue(const spawn_queue& other) = delete;
+    spawn_queue& operator=(const spawn_queue& other) = delete;
+    spawn_queue(spawn_queue&& other) noexcept = default;
+    spawn_queue& operator=(spawn_queue&& other) noexcept = default;
+
+    /// @brief Constructs an empty spawn queue.
+    /// @param ctx The compute context the queue will reside in.
+    /// @param capacity Maximum number of entities spawned between two reconciliations.
+    spawn_queue(const context& ctx, std::size_t capacity);
+
+    /// @brief Returns the maximum number of entities spawned between two reconciliations.
+    [[nodiscard]] std::size_t get_capacity() const;
+
+    /// @brief Binds the counter, the capacity and every component column as kernel arguments.
+    /// @param krn The kernel to bind the queue to.
+    /// @param idx Index of the first argument, advanced past the last bound column.
+    void bind(kernel& krn, std::size_t& idx);
+
+    /// @brief Number of kernel arguments bound by `bind`.
+    static constexpr std::size_t arguments_count = 2 + (component_storage<components_t>::columns_count + ...);
+
+private:
+    std::size_t _capacity;
+    buffer<cl_uint> _count;
+    std::tuple<component_storage<components_t>...> _values;
+    friend struct registry;
+};
+
+/// @brief Device-side append queue of entities to destroy.
+/// Systems receive the queue as a counter, capacity and entity buffer
+/// (`clecs_destroy_params(var)`) and push entity indices, usually obtained through
+/// `entity_ids`, with `clecs_destroy(var, id)`. `registry::reconcile` then destroys every
+/// pushed entity once, ignoring duplicates. Requests beyond the capacity are dropped.
+/// Destroy queues are non-copyable but movable, and are passed to pipelines with `std::ref`.
+struct destroy_queue {
+
+    destroy_queue(const destroy_queue& other) = delete;
+    destroy_queue& operator=(const destroy_queue& other) = delete;
+    destroy_queue(destroy_queue&& other) noexcept = default;
+    destroy_queue& operator=(destroy_queue&& other) noexcept = default;
+
+    /// @brief Constructs an empty destroy queue.
+    /// @param ctx The compute context the queue will reside in.
+    /// @param capacity Maximum number of entities destroyed between two reconciliations.
+    destroy_queue(const context& ctx, std::size_t capacity);
+
+    /// @brief Returns the maximum number of entities destroyed between two reconciliations.
+    [[nodiscard]] std::size_t get_capacity() const;
+
+    /// @brief Binds the counter, the capacity and the entity buffer as kernel arguments.
+    /// @param krn The kernel to bind the queue to.
+    /// @param idx Index of the first argument, advanced past the entity buffer.
+    void bind(kernel& krn, std::size_t& idx);
+
+    /// @brief Number of kernel arguments bound by `bind`.
+    static constexpr std::size_t arguments_count = 3;
+
+private:
+    std::size_t _capacity;
+    buffer<cl_uint> _count;
+    array_buffer<cl_uint> _entities;
+    friend struct registry;
+};
+
+namespace detail {
+
+    template <typename argument_t>
+    struct is_reference_wrapper : std::false_type { };
+
+    template <typename argument_t>
+    struct is_reference_wrapper<std::reference_wrapper<argument_t>> : std::true_type { };
+
+    template <typename argument_t>
+    struct system_argument {
+        static constexpr std::size_t arguments_count = 1;
+    };
+
+    template <typename argument_t>
+    struct system_argument<std::reference_wrapper<argument_t>> : system_argument<argument_t> { };
+
+    template <typename... components_t>
+    struct system_argument<spawn_queue<components_t...>> {
+        static constexpr std::size_t arguments_count = spawn_queue<components_t...>::arguments_count;
+    };
+
+    template <>
+    struct system_argument<destroy_queue> {
+        static constexpr std::size_t arguments_count = destroy_queue::arguments_count;
+    };
+
+}
+
+}
+
+#include "entity_queue.inl"
@@ -0,0 +1,26 @@
+namespace compute {
+
+template <typename... components_t>
+spawn_queue<components_t...>::spawn_queue(const context& ctx, std::size_t capacity)
+    : _capacity(capacity)
+    , _count(ctx)
+    , _values(component_storage<components_t>(ctx, std::max<std::size_t>(capacity, 1))...)
+{
+    _count.set(0u);
+}
+
+template <typename... components_t>
+std::size_t spawn_queue<components_t...>::get_capacity() const
+{
+    return _capacity;
+}
+
+template <typename... components_t>
+void spawn_queue<components_t...>::bind(kernel& krn, std::size_t& idx)
+{
+    krn.set_arg(idx++, _count);
+    krn.set_arg(idx++, static_cast<cl_uint>(_capacity));
+    std::apply([&](auto&... values) { (values.bind(krn, idx), ...); }, _values);
+}
+
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <compute/core/event.hpp>
+#include <compute/core/native.hpp>
+#include <compute/core/thread_pool.hpp>
+#include <compute/ecs/access.hpp>
+#include <compute/ecs/component_storage.hpp>
+#include <compute/ecs/entity.hpp>
+#include <compute/ecs/entity_queue.hpp>
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace compute {
+
+/// @brief Detects systems generated by systemc with a native C++ kernel.
+/// Such systems were included with `CLECS_NATIVE` defined, and declare the C++ version of
+/// their kernel as `native_kernel::smain`.
+/// @tparam system_t The system type to inspect.
+template <typename system_t, typename = void>
+struct has_native_kernel : std::false_type { };
+
+template <typename system_t>
+struct has_native_kernel<system_t, std::void_t<typename system_t::native_kernel>> : std::true_type { };
+
+template <typename system_t>
+inline constexpr bool has_native_kernel_v = has_native_kernel<system_t>::value;
+
+namespace detail {
+
+    template <typename component_t>
+    using native_columns = typename column_buffers<typename component_storage<component_t>::column_types>::vectors;
+
+}
+
+/// @brief ECS registry executing systems as native C++ on host threads.
+/// The `native_registry` offers the interface of `registry` without any OpenCL context:
+/// components are stored in plain host memory, with one vector per field for components
+/// generated with `"layout": "soa"`, and systems run the C++ version of their kernel that
+/// systemc emits when `CLECS_NATIVE` is defined. Work-items are spread over a work-stealing
+/// `thread_pool` in contiguous chunks, so each thread runs a tight loop the compiler can
+/// inline and vectorize, without any enqueue, event or driver call. This suits hosts
+/// without a GPU, and gives a baseline to compare CPU OpenCL runtimes against. Every
+/// operation completes before returning, so the returned futures are always ready.
+/// Native registries are non-copyable but movable.
+struct native_registry {
+
+    native_registry(const native_registry& other) = delete;
+    native_registry& operator=(const native_registry& other) = delete;
+    native_registry(native_registry&& other) noexcept = default;
+    native_registry& operator=(native_registry&& other) noexcept = default;
+
+    /// @brief Constructs a new native registry and starts its threads.
+    /// @param threads_count Number of threads running systems, including the calling
+    /// thread. Zero uses every hardware thread of the host.
+    /// @param capacity Initially reserved number of entities/components (default: 1024).
+    explicit native_registry(std::size_t threads_count = 0, std::size_t capacity = 1024);
+
+    /// @brief Creates a new entity.
+    /// Indices of destroyed entities are recycled with an incremented version.
+    /// @return A unique entity handle.
+    [[nodiscard]] entity create_entity();
+
+    /// @brief Destroys an entity and removes all its components.
+    /// Throws std::runtime_error if the entity is not alive.
+    /// @param e The entity to destroy.
+    future<void> destroy_entity(entity e);
+
+    /// @brief Returns whether an entity handle refers to a living entity.
+    /// @param e The entity handle to check.
+    /// @return `true` if the entity was created and has not been destroyed since.
+    [[nodiscard]] bool is_alive(entity e) const;
+
+    /// @brief Adds a component to the given entity.
+    /// Throws std::runtime_error if the entity is not alive or already has the component.
+    /// @tparam component_t The type of component being added.
+    /// @param e The target entity.
+    /// @param value The value to assign to this entity's component.
+    template <typename component_t>
+    future<void> add_component(entity e, const component_t& value);
+
+    /// @brief Adds the same component type to a batch of entities.
+    /// Entities and values are matched by position.
+    /// @tparam component_t The type of component being added.
+    /// @param entities The target entities.
+    /// @param values The values to assign to each entity's component.
+    template <typename component_t>
+    future<void> add_components(const std::vector<entity>& entities, const std::vector<component_t>& values);
+
+    /// @brief Retrieves a component's value.
+    /// Throws std::runtime_error if the entity does not have this component.
+    /// @tparam component_t The component type to fetch.
+    /// @param e The entity whose component should be fetched.
+    /// @return A ready future holding the component value.
+    template <typename component_t>
+    [[nodiscard]] future<component_t> get_component(entity e);
+
+    /// @brief Removes a component from the given entity.
+    /// The last component of the store is moved into the freed slot (swap-and-pop).
+    /// Throws std::runtime_error if the entity does not have this component.
+    /// @tparam component_t The type of component being removed.
+    /// @param e The target entity.
+    template <typename component_t>
+    future<void> remove_component(entity e);
+
+    /// @brief Executes a system over the entities that have all the specified component types.
+    /// The native kernel of the system is called once per entity, with the same arguments as
+    /// the OpenCL kernel bound by `registry::execute_system`: the component columns, then the
+    /// uniform values. When the components are not stored at matching slots, they are
+    /// gathered into packed vectors before the system and the components it writes are
+    /// scattered back afterwards. Only uniform values and `entity_ids` are supported as
+    /// trailing arguments; spawn and destroy queues require a device registry.
+    /// @tparam system_t The generated system type, included with `CLECS_NATIVE` defined.
+    /// @tparam components_t The component types the system operates on.
+    /// @param uniforms Trivially copyable values matching the trailing kernel parameters.
+    template <typename system_t, typename... components_t, typename... uniforms_t>
+    future<void> execute_system(const uniforms_t&... uniforms);
+
+    /// @brief Returns the number of threads running systems, including the calling thread.
+    [[nodiscard]] std::size_t get_threads_count() const;
+
+private:
+    struct component_store {
+        std::shared_ptr<void> data;
+        std::unordered_map<std::uint32_t, std::size_t> entity_slots;
+        std::vector<std::uint32_t> slot_entities;
+        std::function<void(std::size_t, std::size_t)> move;
+        std::function<void()> pop;
+    };
+    struct component_join {
+        bool aligned = true;
+        std::size_t count = 0;
+        std::vector<std::vector<std::size_t>> slots;
+        std::vector<cl_uint> entities;
+    };
+    std::unique_ptr<thread_pool> _pool;
+    std::size_t _capacity;
+    std::uint32_t _next_entity;
+    std::vector<std::uint32_t> _entity_versions;
+    std::vector<bool> _entity_alive;
+    std::vector<std::uint32_t> _free_entities;
+    std::unordered_map<std::type_index, component_store> _component_stores;
+    template <typename component_t>
+    component_store& _get_or_create_component_store();
+    template <typename component_t>
+    static detail::native_columns<component_t>& _get_columns(component_store& store);
+    template <typename component_t>
+    void _gather_component(detail::native_columns<component_t>& packed, component_store& store, const std::vector<std::size_t>& slots);
+    template <typename component_t>
+    void _scatter_component(detail::native_columns<component_t>& packed, component_store& store, const std::vector<std::size_t>& slots);
+    template <typename argument_t>
+    static auto _get_argument(const argument_t& value, const component_join& join);
+    std::uint32_t _get_alive_index(entity e) const;
+    std::size_t _insert_components(component_store& store, const std::vector<entity>& entities);
+    void _erase_component(component_store& store, std::uint32_t idx);
+    component_join _get_join(const std::vector<component_store*>& stores, bool entities) const;
+};
+
+}
+
+#include "native_registry.inl"
@@ -0,0 +1,169 @@
+namespace compute {
+
+template <typename component_t>
+future<void> native_registry::add_component(entity e, const component_t& value)
+{
+    return add_components<component_t>({ e }, { value });
+}
+
+template <typename component_t>
+future<void> native_registry::add_components(const std::vector<entity>& entities, const std::vector<component_t>& values)
+{
+    if (entities.size() != values.size()) {
+        throw std::invalid_argument("Entities and component values must have the same size");
+    }
+    auto& _store = _get_or_create_component_store<component_t>();
+    _insert_components(_store, entities);
+    std::apply([&](auto&... columns) {
+        for (const auto& _value : values) {
+            std::apply([&](const auto&... fields) { (columns.push_back(fields), ...); }, detail::component_columns<component_t>::tie(_value));
+        }
+    }, _get_columns<component_t>(_store));
+    return detail::make_ready_future();
+}
+
+template <typename component_t>
+future<component_t> native_registry::get_component(entity e)
+{
+    auto _it = _component_stores.find(std::type_index(typeid(component_t)));
+    if (_it == _component_stores.end()) {
+        throw std::runtime_error("Component not found for entity");
+    }
+    auto _slot = _it->second.entity_slots.find(_get_alive_index(e));
+    if (_slot == _it->second.entity_slots.end()) {
+        throw std::runtime_error("Component not found for entity");
+    }
+    auto _value = component_t {};
+    detail::component_columns<component_t>::tie(_value) = std::apply([&](const auto&... columns) { return std::make_tuple(columns[_slot->second]...); }, _get_columns<component_t>(_it->second));
+    auto _promise = std::promise<component_t> {};
+    _promise.set_value(_value);
+    return future<component_t>(_promise.get_future(), event {});
+}
+
+template <typename component_t>
+future<void> native_registry::remove_component(entity e)
+{
+    auto _it = _component_stores.find(std::type_index(typeid(component_t)));
+    auto _idx = _get_alive_index(e);
+    if (_it == _component_stores.end() || _it->second.entity_slots.find(_idx) == _it->second.entity_slots.end()) {
+        throw std::runtime_error("Component not found for entity");
+    }
+    _erase_component(_it->second, _idx);
+    return detail::make_ready_future();
+}
+
+template <typename system_t, typename... components_t, typename... uniforms_t>
+future<void> native_registry::execute_system(const uniforms_t&... uniforms)
+{
+    static_assert(has_native_kernel_v<system_t>, "Native systems must be generated by systemc and included with CLECS_NATIVE defined");
+    static_assert(((std::is_trivially_copyable_v<uniforms_t> && detail::system_argument<uniforms_t>::arguments_count == 1) && ...), "Native systems only accept uniform values and entity_ids");
+    constexpr auto _ids = (std::is_same_v<uniforms_t, entity_ids> || ...);
+    auto _stores = std::vector<component_store*> { &_get_or_create_component_store<component_type_t<components_t>>()... };
+    if (_ids && _stores.empty()) {
+        throw std::runtime_error("Entity ids require at least one component");
+    }
+    auto _join = _stores.empty() ? component_join {} : _get_join(_stores, _ids);
+    if (_stores.empty()) {
+        _join.count = _next_entity;
+    }
+    if (_join.count == 0) {
+        return detail::make_ready_future();
+    }
+    auto _read_only = detail::get_read_only_components<system_t, components_t...>(sizeof...(uniforms_t));
+    auto _packed = std::tuple<detail::native_columns<component_type_t<components_t>>...> {};
+    auto _idx = std::size_t { 0 };
+    if (!_join.aligned) {
+        std::apply([&](auto&... packed) { ((_gather_component<component_type_t<components_t>>(packed, *_stores[_idx], _join.slots[_idx]), ++_idx), ...); }, _packed);
+    }
+    // the kernel receives one pointer per column, then the uniforms by value
+    _idx = 0;
+    auto _next_store = [&]() { return _stores[_idx++]; };
+    auto _columns = std::apply([&](auto&... packed) {
+        return std::tuple<detail::native_columns<component_type_t<components_t>>*...> { (_join.aligned ? &_get_columns<component_type_t<components_t>>(*_next_store()) : &packed)... };
+    }, _packed);
+    auto _arguments = std::tuple_cat(std::apply([](auto*... columns) {
+        return std::tuple_cat(std::apply([](auto&... column) { return std::make_tuple(column.data()...); }, *columns)...);
+    }, _columns), std::make_tuple(_get_argument(uniforms, _join)...));
+    _pool->parallel_for(_join.count, thread_pool::chunk_alignment, [&](std::size_t begin, std::size_t end) {
+        native::current_work_item.global_size = _join.count;
+        for (auto _k = begin; _k < end; ++_k) {
+            native::current_work_item.global_id = _k;
+            std::apply([](auto... arguments) { system_t::native_kernel::smain(arguments...); }, _arguments);
+        }
+    });
+    if (!_join.aligned) {
+        _idx = 0;
+        std::apply([&](auto&... packed) { (((_read_only[_idx] ? void() : _scatter_component<component_type_t<components_t>>(packed, *_stores[_idx], _join.slots[_idx])), ++_idx), ...); }, _packed);
+    }
+    return detail::make_ready_future();
+}
+
+template <typename component_t>
+native_registry::component_store& native_registry::_get_or_create_component_store()
+{
+    auto _type = std::type_index(typeid(component_t));
+    auto _it = _component_stores.find(_type);
+    if (_it != _component_stores.end()) {
+        return _it->second;
+    }
+    auto _columns = std::make_shared<detail::native_columns<component_t>>();
+    std::apply([&](auto&... columns) { (columns.reserve(_capacity), ...); }, *_columns);
+    auto& _store = _component_stores[_type];
+    _store.data = _columns;
+    _store.move = [_columns = _columns.get()](std::size_t dst, std::size_t src) {
+        std::apply([&](auto&... columns) { ((columns[dst] = columns[src]), ...); }, *_columns);
+    };
+    _store.pop = [_columns = _columns.get()]() {
+        std::apply([](auto&... columns) { (columns.pop_back(), ...); }, *_columns);
+    };
+    return _store;
+}
+
+template <typename component_t>
+detail::native_columns<component_t>& native_registry::_get_columns(component_store& store)
+{
+    return *std::static_pointer_cast<detail::native_columns<component_t>>(store.data);
+}
+
+template <typename component_t>
+void native_registry::_gather_component(detail::native_columns<component_t>& packed, component_store& store, const std::vector<std::size_t>& slots)
+{
+    auto& _columns = _get_columns<component_t>(store);
+    std::apply([&](auto&... packed_columns) { (packed_columns.resize(slots.size()), ...); }, packed);
+    _pool->parallel_for(slots.size(), thread_pool::chunk_alignment, [&](std::size_t begin, std::size_t end) {
+        std::apply([&](auto&... packed_columns) {
+            std::apply([&](const auto&... columns) {
+                for (auto _k = begin; _k < end; ++_k) {
+                    ((packed_columns[_k] = columns[slots[_k]]), ...);
+                }
+            }, _columns);
+        }, packed);
+    });
+}
+
+template <typename component_t>
+void native_registry::_scatter_component(detail::native_columns<component_t>& packed, component_store& store, const std::vector<std::size_t>& slots)
+{
+    auto& _columns = _get_columns<component_t>(store);
+    _pool->parallel_for(slots.size(), thread_pool::chunk_alignment, [&](std::size_t begin, std::size_t end) {
+        std::apply([&](const auto&... packed_columns) {
+            std::apply([&](auto&... columns) {
+                for (auto _k = begin; _k < end; ++_k) {
+                    ((columns[slots[_k]] = packed_columns[_k]), ...);
+                }
+            }, _columns);
+        }, packed);
+    });
+}
+
+template <typename argument_t>
+auto native_registry::_get_argument(const argument_t& value, const component_join& join)
+{
+    if constexpr (std::is_same_v<argument_t, entity_ids>) {
+        return join.entities.data();
+    } else {
+        return value;
+    }
+}
+
+}
@@ -3,17 +3,73 @@
 #include <compute/core/buffer.hpp>
 #include <compute/core/context.hpp>
 #include <compute/core/kernel.hpp>
+#include <compute/ecs/access.hpp>
+#include <compute/ecs/component_storage.hpp>
 #include <compute/ecs/entity.hpp>
+#include <compute/ecs/entity_queue.hpp>
 
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 #include <typeindex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace compute {
 
+struct registry;
+struct command_buffer;
+
+/// @brief Ordered list of systems executed together by `registry::step`.
+/// Systems are added with the same template arguments as `registry::execute_system`
+/// and behave as if they ran in the order they were added. Component types wrapped in
+/// `read<>` or qualified with `const`, and components bound to `const` kernel parameters,
+/// are only read by the system, which lets systems reading the same components, or
+/// touching disjoint ones, run concurrently. Pipelines only describe
+/// work, so the same pipeline can be stepped on several registries.
+struct pipeline {
+
+    /// @brief Appends a system to the pipeline.
+    /// @tparam system_t The generated system type to execute.
+    /// @tparam components_t The component types the system operates on.
+    /// @param uniforms Values passed to the system after the component buffers, at every step.
+    /// Queues are passed with `std::ref`, since pipelines keep a copy of every value.
+    /// @return This pipeline, so that calls can be chained.
+    template <typename system_t, typename... components_t, typename... uniforms_t>
+    pipeline& add(const uniforms_t&... uniforms);
+
+    /// @brief Returns the number of systems in the pipeline.
+    /// @return The number of systems executed at every step.
+    [[nodiscard]] std::size_t get_size() const;
+
+private:
+    struct stage {
+        std::vector<std::type_index> reads;
+        std::vector<std::type_index> writes;
+        std::vector<std::type_index> join;
+        std::function<future<void>(registry&, std::size_t, const std::vector<event>&)> dispatch;
+    };
+    std::vector<stage> _stages;
+    bool _uniforms_only = true;
+    friend struct registry;
+    friend struct sharded_registry;
+};
+
 /// @brief Central coordinator for device-resident ECS data and system execution.
 /// The `registry` manages creation of entities, association of component data
 /// (stored on device), and execution of systems via OpenCL kernels. All components
-/// are stored in contiguous device memory using `array_buffer<component_t>`, allowing
-/// compute kernels to process large sets of entities in parallel.
+/// are stored in contiguous device memory using `component_storage<component_t>`, allowing
+/// compute kernels to process large sets of entities in parallel. Components generated
+/// with `"layout": "soa"` are stored with one buffer per field and bound to system kernels
+/// as one argument per field. For every component
+/// type the registry also keeps entity-to-slot and slot-to-entity tables resident on the
+/// device, which are used to join component types when a system requires several of them.
 /// It is the main interface users interact with to construct ECS scenes,
 /// assign components, and run systems on the device.
 /// @note The registry does not store component values on the host; it assumes
@@ -26,49 +82,293 @@ struct registry {
     registry& operator=(registry&& other) noexcept = default;
 
     /// @brief Constructs a new ECS registry backed by a given GPU context.
+    /// Component stores and entity tables start with `capacity` elements and grow
+    /// geometrically on the device whenever more entities or components are added.
     /// @param ctx The device context used for all memory allocations and kernel launches.
-    /// @param capacity Pre-allocated number of entities/components (default: 1024).
-    registry(const context& ctx, size_t capacity = 1024);
+    /// @param capacity Initially allocated number of entities/components (default: 1024).
+    /// @param options Build options used when compiling system kernels (can be empty).
+    registry(const context& ctx, size_t capacity = 1024, const std::string& options = "");
 
     /// @brief Creates a new entity.
     /// Returns a unique `entity` identifier. The entity initially has no components.
     /// Component storage for entities is managed by the registry internally.
+    /// Indices of destroyed entities are recycled with an incremented version.
     /// @return A unique entity handle.
     [[nodiscard]] entity create_entity();
 
+    /// @brief Destroys an entity and removes all its components.
+    /// Each removal compacts its component store on the device by moving the last
+    /// component into the freed slot. The entity index is then recycled, and the
+    /// handle (as well as any copy of it) is no longer alive.
+    /// Throws std::runtime_error if the entity is not alive.
+    /// @param e The entity to destroy.
+    /// @return A future resolving once the component stores have been compacted.
+    future<void> destroy_entity(entity e);
+
+    /// @brief Returns whether an entity handle refers to a living entity.
+    /// @param e The entity handle to check.
+    /// @return `true` if the entity was created and has not been destroyed since.
+    [[nodiscard]] bool is_alive(entity e) const;
+
     /// @brief Adds a component to the given entity.
     /// If the component type has not yet been registered, a device buffer for that
     /// component type is automatically allocated. The value is copied to the device.
+    /// Generated components are checked once against their device layout when their
+    /// buffer is allocated; std::runtime_error is thrown if host and device disagree.
     /// @tparam component_t The type of component being added.
     /// @param e The target entity.
     /// @param value The value to assign to this entity’s component.
     template <typename component_t>
-    std::future<void> add_component(entity e, const component_t& value);
+    future<void> add_component(entity e, const component_t& value);
+
+    /// @brief Adds the same component type to a batch of entities.
+    /// The values are uploaded to the device with a single write, which makes this
+    /// the preferred path when spawning many entities at once. Entities and values
+    /// are matched by position.
+    /// @tparam component_t The type of component being added.
+    /// @param entities The target entities.
+    /// @param values The values to assign to each entity's component.
+    template <typename component_t>
+    future<void> add_components(const std::vector<entity>& entities, const std::vector<component_t>& values);
 
     /// @brief Asynchronously retrieves a component's value from the device.
     /// This performs a non-blocking read of the component associated with an entity,
-    /// returning a `std::future` that resolves with the host-side copy.
+    /// returning a `future` that resolves with the host-side copy.
     /// @tparam component_t The component type to fetch.
     /// @param e The entity whose component should be fetched.
     /// @return A future resolving to the component value.
     template <typename component_t>
-    [[nodiscard]] std::future<component_t> get_component(entity e);
+    [[nodiscard]] future<component_t> get_component(entity e);
+
+    /// @brief Fetches the components that changed since the previous call.
+    /// The first call enables change tracking for the component type and returns every
+    /// component. The registry then keeps a device copy of the values at the time of the
+    /// last call, and later calls compare it with the current values on the device,
+    /// compact the slots that differ and read back only those components with their
+    /// entity, so readback bandwidth scales with the number of changes. Components added
+    /// or moved by removals are reported as changed; removed components are not. When no
+    /// system declared as writing the component ran and no component was added or
+    /// removed since the last call, nothing is enqueued at all. Blocks until the number of
+    /// changed components has been read back.
+    /// @tparam component_t The component type to fetch.
+    /// @return A future resolving to the changed entities and their component values.
+    template <typename component_t>
+    [[nodiscard]] future<std::vector<std::pair<entity, component_t>>> fetch_changed();
+
+    /// @brief Removes a component from the given entity.
+    /// The last component of the store is moved into the freed slot on the device
+    /// (swap-and-pop), so the store stays dense without any host round trip.
+    /// Throws std::runtime_error if the entity does not have this component.
+    /// @tparam component_t The type of component being removed.
+    /// @param e The target entity.
+    /// @return A future resolving once the store has been compacted.
+    template <typename component_t>
+    future<void> remove_component(entity e);
 
     /// @brief Executes a user-defined system over the specified component types.
     /// This method prepares the component buffers as kernel arguments and
     /// dispatches a compute kernel generated from the user-defined `system_t`.
-    /// The kernel will be launched with global work size equal to entity capacity.
-    template <typename system_t, typename... components_t>
-    std::future<void> execute_system();
+    /// The kernel is launched over the entities that have all the requested components,
+    /// with global work size equal to their count. Systems generated with a bounds guard are
+    /// dispatched with `kernel::run_tuned` instead, which pads the global size to a multiple
+    /// of a work-group size tuned per entity count. When these components are not stored
+    /// at matching slots, the registry joins them on the device, gathers the matching
+    /// components into packed buffers for the system and scatters the results back.
+    /// The system kernel is compiled on first use and cached by the registry, so
+    /// subsequent calls only rebind the component buffers and enqueue. Components can be
+    /// listed as `read<component_t>` (or `const component_t`) and `write<component_t>`;
+    /// components bound to `const` kernel parameters are read-only as well. Read-only
+    /// components are not scattered back after the system. Throws std::runtime_error if
+    /// the system writes a component type declared with `declare_read_only`.
+    /// Uniform values such as a frame delta time are bound by value after the component
+    /// buffers, in order, so they need no device buffer nor transfer.
+    /// `entity_ids`, `spawn_queue` and `destroy_queue` arguments are bound the same way.
+    /// @param uniforms Trivially copyable values matching the trailing kernel parameters.
+    template <typename system_t, typename... components_t, typename... uniforms_t>
+    future<void> execute_system(uniforms_t&&... uniforms);
+
+    /// @brief Declares that systems never write a component type.
+    /// The device buffer of the component type is then allocated with `CL_MEM_READ_ONLY`,
+    /// so that the driver can place it in read-optimized memory. Values can still be set
+    /// and fetched from the host. Removals and command buffer updates of the type are then
+    /// applied with buffer copies and host writes instead of kernels, one per component.
+    /// Must be called before the component type is first added.
+    /// Throws std::runtime_error if the component store already exists.
+    /// @tparam component_t The component type only read by systems.
+    template <typename component_t>
+    void declare_read_only();
+
+    /// @brief Creates the entities requested by systems through a spawn queue, then empties it.
+    /// Only the number of requests is read back: the components of the new entities are
+    /// copied from the queue into the component stores on the device. Requests beyond the
+    /// capacity of the queue are dropped. Call this between systems or pipeline steps.
+    /// @tparam components_t The component types of every spawned entity.
+    /// @param queue The spawn queue the systems appended to.
+    /// @return A future resolving once the components of the new entities are in place.
+    template <typename... components_t>
+    future<void> reconcile(spawn_queue<components_t...>& queue);
+
+    /// @brief Destroys the entities requested by systems through a destroy queue, then empties it.
+    /// The requested entity indices are read back and destroyed as one batch, like a
+    /// `command_buffer`; entities requested several times or already destroyed are ignored.
+    /// Requests beyond the capacity of the queue are dropped.
+    /// @param queue The destroy queue the systems appended to.
+    /// @return A future resolving once the component stores have been compacted.
+    future<void> reconcile(destroy_queue& queue);
+
+    /// @brief Applies every command recorded in a command buffer, then empties it.
+    /// Removals and entity destructions are applied first, as one batch per component
+    /// store: the host computes the final swap-and-pop layout and the device moves all the
+    /// displaced components with one gather and one scatter kernel. Additions are then
+    /// uploaded with one write per store and column, and updates with one write and one
+    /// scatter kernel per store. Everything is validated before the first change, and
+    /// std::runtime_error is thrown if an entity is not alive, lacks a removed or updated
+    /// component, is added a component it already has or that is added twice, or gets
+    /// components while being destroyed. Updates see the components added and removed by
+    /// the same command buffer. Throws std::invalid_argument
+    /// if the command buffer records changes for another registry.
+    /// @param cmd The command buffer to apply.
+    /// @return A future resolving once every change has been applied on the device.
+    future<void> apply(command_buffer& cmd);
+
+    /// @brief Compiles and caches the kernel of a user-defined system ahead of time.
+    /// Calling this during loading moves the OpenCL build cost out of the first
+    /// `execute_system` call. Compiling an already cached system is a no-op.
+    /// @tparam system_t The generated system type to compile.
+    template <typename system_t>
+    void compile_system();
+
+    /// @brief Runs a pipeline of systems several times back to back on the device.
+    /// Every dispatch of every step is enqueued without any host synchronization in
+    /// between, so fixed-timestep loops are bound by device throughput instead of host
+    /// latency. Only the first step may wait for the device, to rebuild the joins of
+    /// component sets that changed since the last execution. Waiting on the returned
+    /// future or fetching a component afterwards is the only synchronization point.
+    /// When the context has several queues, systems are spread over them and only
+    /// ordered by events where they access the same components and at least one of them
+    /// writes, so that independent systems overlap on the device.
+    /// @param steps Number of times the whole pipeline is enqueued.
+    /// @param pl The systems to run at every step, in order.
+    /// @return A future resolving once the last system of the last step has completed.
+    future<void> step(std::size_t steps, const pipeline& pl);
+
+    /// @brief Returns the device timings of every dispatch of a system kernel.
+    /// Only the system kernel itself is measured; the gather and scatter dispatches of
+    /// unaligned joins are recorded separately and appear in the trace.
+    /// Throws std::runtime_error if the context was created without `CL_QUEUE_PROFILING_ENABLE`.
+    /// @tparam system_t The generated system type.
+    /// @return The statistics of the system, waiting for all recorded commands to complete.
+    template <typename system_t>
+    [[nodiscard]] profiling_statistics get_system_statistics() const;
+
+    /// @brief Returns the device timings and bandwidth of the transfers of a component store.
+    /// Covers every write, read, fill, copy and reallocation of the component values.
+    /// Throws std::runtime_error if the context was created without `CL_QUEUE_PROFILING_ENABLE`.
+    /// @tparam component_t The component type.
+    /// @return The statistics of the store, waiting for all recorded commands to complete.
+    template <typename component_t>
+    [[nodiscard]] profiling_statistics get_component_statistics() const;
+
+    /// @brief Writes every command recorded in the context as a Chrome trace JSON file.
+    /// Throws std::runtime_error if the context was created without `CL_QUEUE_PROFILING_ENABLE`.
+    /// @param path Path of the JSON file to write.
+    void dump_trace(const std::filesystem::path& path) const;
 
 private:
+    struct component_store {
+        std::shared_ptr<void> data;
+        std::shared_ptr<compute::array_buffer<cl_uint>> slots;
+        std::shared_ptr<compute::array_buffer<cl_uint>> entities;
+        std::unordered_map<std::uint32_t, std::size_t> entity_slots;
+        std::vector<std::uint32_t> slot_entities;
+        std::function<future<void>(std::size_t, std::size_t)> move;
+        std::function<future<void>(std::size_t)> resize;
+        std::function<future<void>(registry&, component_store&, std::size_t)> move_slots;
+        std::shared_ptr<void> staging;
+        std::shared_ptr<void> shadow;
+        std::size_t shadow_count = 0;
+        bool dirty = true;
+        bool read_only = false;
+    };
+    struct component_join {
+        std::size_t version = 0;
+        std::size_t count = 0;
+        bool aligned = false;
+        std::vector<std::shared_ptr<compute::array_buffer<cl_uint>>> matches;
+        std::vector<std::shared_ptr<void>> packed;
+        std::shared_ptr<compute::array_buffer<cl_uint>> entities;
+    };
     const context& _context;
     std::size_t _capacity;
+    std::size_t _entity_capacity;
     std::uint32_t _next_entity;
-    std::unordered_map<std::type_index, std::shared_ptr<void>> _component_stores;
-    std::unordered_map<std::type_index, std::unordered_map<entity, std::size_t>> _entity_component_map;
+    std::vector<std::uint32_t> _entity_versions;
+    std::vector<bool> _entity_alive;
+    std::vector<std::uint32_t> _free_entities;
+    std::size_t _structure_version;
+    std::unordered_map<std::type_index, component_store> _component_stores;
+    std::map<std::vector<std::type_index>, component_join> _component_joins;
+    std::string _build_options;
+    std::unordered_set<std::type_index> _read_only_types;
+    std::map<std::pair<std::type_index, std::string>, std::shared_ptr<compute::kernel>> _system_kernels;
+    std::map<std::string, std::shared_ptr<compute::kernel>> _builtin_kernels;
+    std::shared_ptr<compute::array_buffer<cl_uint>> _join_mask;
+    std::shared_ptr<compute::array_buffer<cl_uint>> _join_positions;
+    std::shared_ptr<compute::buffer<cl_uint>> _join_counter;
+    std::vector<std::shared_ptr<compute::array_buffer<cl_uint>>> _join_probes;
+    std::shared_ptr<compute::array_buffer<cl_uint>> _changed_slots;
+    std::shared_ptr<compute::array_buffer<cl_uint>> _command_sources;
+    std::shared_ptr<compute::array_buffer<cl_uint>> _command_destinations;
+    std::shared_ptr<compute::array_buffer<cl_uint>> _command_indices;
+    std::shared_ptr<compute::array_buffer<cl_uint>> _command_values;
+    friend struct pipeline;
+    friend struct command_buffer;
+    struct component_access {
+        event write;
+        std::vector<event> reads;
+    };
+    template <typename system_t, typename... components_t, typename... uniforms_t>
+    future<void> _dispatch_system(std::size_t queue_idx, const std::vector<event>& wait_list, uniforms_t&&... uniforms);
+    template <typename argument_t>
+    void _bind_argument(compute::kernel& krn, std::size_t& idx, argument_t&& value, compute::array_buffer<cl_uint>* entities);
+    template <typename system_t>
+    static future<void> _run_system(compute::kernel& krn, std::size_t idx, std::size_t count, const std::vector<event>& wait_list, std::size_t queue_idx);
+    template <typename component_t>
+    future<void> _spawn_components(compute::component_storage<component_t>& values, const std::vector<entity>& entities);
+    template <typename component_t>
+    std::shared_ptr<compute::component_storage<component_t>> _get_or_create_component_store();
+    template <typename system_t>
+    std::shared_ptr<compute::kernel> _get_or_create_system_kernel();
+    template <typename buffer_t>
+    void _reserve_scratch(std::shared_ptr<buffer_t>& buffer, std::size_t size);
+    template <typename component_t>
+    static std::size_t _get_copy_words();
+    template <typename component_t>
+    static std::string _get_copy_options();
+    template <typename component_t>
+    future<void> _copy_slots(const std::string& name, compute::component_storage<component_t>& src, compute::component_storage<component_t>& dst, compute::array_buffer<cl_uint>& slots, std::size_t count, std::size_t queue_idx = 0, const std::vector<event>& wait_list = {});
+    template <typename component_t>
+    future<void> _move_slots(component_store& store, std::size_t count);
+    template <typename component_t>
+    future<void> _add_components(const std::vector<entity>& entities, std::vector<component_t>&& values);
+    template <typename component_t>
+    future<void> _set_components(const std::vector<entity>& entities, std::vector<component_t>&& values);
+    template <typename component_t>
+    future<void> _gather_component(component_join& join, std::size_t idx, std::size_t queue_idx, const std::vector<event>& wait_list);
     template <typename component_t>
-    std::shared_ptr<compute::array_buffer<component_t>> _get_or_create_component_store();
+    future<void> _scatter_component(component_join& join, std::size_t idx, std::size_t queue_idx);
+    component_store& _register_component_store(const std::type_index& type, const std::shared_ptr<void>& data);
+    std::uint32_t _get_alive_index(entity e) const;
+    std::shared_ptr<profiler> _get_profiler() const;
+    std::size_t _insert_components(component_store& store, const std::vector<entity>& entities);
+    future<void> _erase_component(component_store& store, std::uint32_t idx);
+    std::size_t _compact_changes(std::size_t count);
+    future<void> _erase_components(component_store& store, const std::vector<std::uint32_t>& indices);
+    future<void> _scatter_table(compute::array_buffer<cl_uint>& table, std::vector<cl_uint>&& indices, std::vector<cl_uint>&& values);
+    future<void> _run_scatter_table(compute::array_buffer<cl_uint>& table, compute::array_buffer<cl_uint>& indices, compute::array_buffer<cl_uint>& values, std::size_t count);
+    future<void> _run_gather_table(compute::array_buffer<cl_uint>& table, compute::array_buffer<cl_uint>& indices, compute::array_buffer<cl_uint>& values, std::size_t count, std::size_t queue_idx, const std::vector<event>& wait_list);
+    component_join& _get_or_update_join(const std::vector<std::type_index>& types);
+    std::shared_ptr<compute::kernel> _get_or_create_builtin_kernel(const std::string& name, const std::string& options = "");
 };
 
 }
@@ -1,58 +1,449 @@
 namespace compute {
 
-template <typename component_t>
-std::future<void> registry::add_component(entity e, const component_t& value)
+template <typename system_t, typename... components_t, typename... uniforms_t>
+pipeline& pipeline::add(const uniforms_t&... uniforms)
 {
-    auto& _entity_map = _entity_component_map[std::type_index(typeid(component_t))];
-    if (_entity_map.find(e) != _entity_map.end()) {
-        throw std::runtime_error("Component already added to entity");
+    auto _stage = stage {};
+    auto _read_only = detail::get_read_only_components<system_t, components_t...>((std::size_t { 0 } + ... + detail::system_argument<std::decay_t<uniforms_t>>::arguments_count));
+    _stage.join = { std::type_index(typeid(component_type_t<components_t>))... };
+    for (std::size_t _k = 0; _k < _stage.join.size(); ++_k) {
+        (_read_only[_k] ? _stage.reads : _stage.writes).push_back(_stage.join[_k]);
     }
+    _stage.dispatch = [uniforms...](registry& reg, std::size_t queue_idx, const std::vector<event>& wait_list) {
+        return reg._dispatch_system<system_t, components_t...>(queue_idx, wait_list, uniforms...);
+    };
+    _stages.push_back(std::move(_stage));
+    // queues and entity ids are bound to the buffers of a single registry
+    _uniforms_only = _uniforms_only && ((!std::is_same_v<std::decay_t<uniforms_t>, entity_ids> && detail::system_argument<std::decay_t<uniforms_t>>::arguments_count == 1) && ...);
+    return *this;
+}
+
+template <typename component_t>
+future<void> registry::add_component(entity e, const component_t& value)
+{
     auto _buffer = _get_or_create_component_store<component_t>();
-    auto _idx = _entity_map.size();
-    if (_idx >= _buffer->get_size()) {
-        throw std::runtime_error("Exceeded component buffer capacity");
+    auto& _store = _component_stores.at(std::type_index(typeid(component_t)));
+    auto _idx = _insert_components(_store, { e });
+    return _buffer->set(_idx, value);
+}
+
+template <typename component_t>
+future<void> registry::add_components(const std::vector<entity>& entities, const std::vector<component_t>& values)
+{
+    if (entities.size() != values.size()) {
+        throw std::invalid_argument("Entities and component values must have the same size");
     }
-    _entity_map[e] = _idx;
-    auto _temp = _buffer->fetch().get();
-    _temp[_idx] = value;
-    return _buffer->set(_temp);
+    auto _buffer = _get_or_create_component_store<component_t>();
+    auto& _store = _component_stores.at(std::type_index(typeid(component_t)));
+    auto _first_idx = _insert_components(_store, entities);
+    return _buffer->set(_first_idx, values);
 }
 
 template <typename component_t>
-std::future<component_t> registry::get_component(entity e)
+future<component_t> registry::get_component(entity e)
 {
-    const auto& _entity_map = _entity_component_map.at(std::type_index(typeid(component_t)));
-    if (_entity_map.find(e) == _entity_map.end()) {
+    auto _it = _component_stores.find(std::type_index(typeid(component_t)));
+    if (_it == _component_stores.end()) {
+        throw std::runtime_error("Component not found for entity");
+    }
+    auto _slot = _it->second.entity_slots.find(_get_alive_index(e));
+    if (_slot == _it->second.entity_slots.end()) {
         throw std::runtime_error("Component not found for entity");
     }
-    auto _idx = _entity_map.at(e);
-    auto _buffer = std::static_pointer_cast<compute::array_buffer<component_t>>(_component_stores.at(std::type_index(typeid(component_t))));
-    return _buffer->fetch(_idx);
+    auto _buffer = std::static_pointer_cast<compute::component_storage<component_t>>(_it->second.data);
+    return _buffer->fetch(_slot->second);
 }
 
-template <typename system_t, typename... components_t>
-std::future<void> registry::execute_system()
+template <typename component_t>
+future<std::vector<std::pair<entity, component_t>>> registry::fetch_changed()
 {
-    return std::async(std::launch::async, [this]() {
-        auto _krn = compute::kernel(_context, system_t::kernel_source, "smain");
-        auto _entity_count = _next_entity;
-        auto _idx = 0;
-        (_krn.set_arg(_idx++, *_get_or_create_component_store<components_t>()), ...);
-        return _krn.run({ _entity_count }).get();
+    auto _it = _component_stores.find(std::type_index(typeid(component_t)));
+    auto _count = _it == _component_stores.end() ? 0 : _it->second.slot_entities.size();
+    if (_count == 0 || !_it->second.dirty) {
+        if (_it != _component_stores.end()) {
+            _it->second.shadow_count = _count;
+            _it->second.dirty = false;
+        }
+        auto _promise = std::promise<std::vector<std::pair<entity, component_t>>> {};
+        _promise.set_value({});
+        return future<std::vector<std::pair<entity, component_t>>>(_promise.get_future(), event {});
+    }
+    auto& _store = _it->second;
+    auto _buffer = std::static_pointer_cast<compute::component_storage<component_t>>(_store.data);
+    auto _shadow = std::static_pointer_cast<compute::component_storage<component_t>>(_store.shadow);
+    if (!_shadow) {
+        _shadow = std::make_shared<compute::component_storage<component_t>>(_context, _buffer->get_size());
+        _shadow->set_label(std::string(typeid(component_t).name()) + " shadow");
+        _store.shadow = _shadow;
+        _store.shadow_count = 0;
+    } else if (_shadow->get_size() < _buffer->get_size()) {
+        _shadow->resize(_buffer->get_size());
+    }
+
+    // every column marks the slots whose words differ from the copy taken at the last call
+    _reserve_scratch(_join_mask, _count);
+    _join_mask->fill(0u, 0, _count);
+    _buffer->for_each_column(*_shadow, [&](auto& column, auto& shadow_column) {
+        using column_t = typename std::decay_t<decltype(column)>::value_type;
+        auto _krn = _get_or_create_builtin_kernel("clecs_diff", _get_copy_options<column_t>());
+        _krn->set_label(std::string("clecs_diff ") + typeid(component_t).name());
+        _krn->set_arg(0, column);
+        _krn->set_arg(1, shadow_column);
+        _krn->set_arg(2, *_join_mask);
+        _krn->set_arg(3, static_cast<cl_uint>(std::min(_store.shadow_count, _count)));
+        _krn->run({ _count });
+    });
+    auto _changed = _compact_changes(_count);
+
+    auto _packed = std::static_pointer_cast<compute::component_storage<component_t>>(_store.staging);
+    _reserve_scratch(_packed, std::max<std::size_t>(_changed, 1));
+    _store.staging = _packed;
+    _copy_slots<component_t>("clecs_gather", *_buffer, *_packed, *_changed_slots, _changed);
+    auto _slots = std::vector<cl_uint>(_changed);
+    auto _slots_fetched = _changed_slots->fetch(_slots.data(), 0, _changed);
+    auto _values = std::make_shared<future<std::vector<component_t>>>(_packed->fetch_range(0, _changed));
+    _shadow->copy(*_buffer, 0, 0, _count);
+    _store.shadow_count = _count;
+    _store.dirty = false;
+
+    // slots are mapped to entities while the registry still matches the device state
+    _slots_fetched.get();
+    auto _entities = std::vector<entity>(_changed);
+    for (std::size_t _k = 0; _k < _changed; ++_k) {
+        auto _idx = _store.slot_entities[_slots[_k]];
+        _entities[_k] = make_entity(_idx, _entity_versions[_idx]);
+    }
+    auto _last = _values->get_event();
+    auto _joined = std::async(std::launch::deferred, [_values, _entities = std::move(_entities)]() {
+        auto _fetched = _values->get();
+        auto _pairs = std::vector<std::pair<entity, component_t>>(_fetched.size());
+        for (std::size_t _k = 0; _k < _fetched.size(); ++_k) {
+            _pairs[_k] = std::make_pair(_entities[_k], std::move(_fetched[_k]));
+        }
+        return _pairs;
     });
+    return future<std::vector<std::pair<entity, component_t>>>(std::move(_joined), _last);
+}
+
+template <typename component_t>
+future<void> registry::remove_component(entity e)
+{
+    auto _it = _component_stores.find(std::type_index(typeid(component_t)));
+    auto _idx = _get_alive_index(e);
+    if (_it == _component_stores.end() || _it->second.entity_slots.find(_idx) == _it->second.entity_slots.end()) {
+        throw std::runtime_error("Component not found for entity");
+    }
+    return _erase_component(_it->second, _idx);
+}
+
+template <typename system_t, typename... components_t, typename... uniforms_t>
+future<void> registry::execute_system(uniforms_t&&... uniforms)
+{
+    return _dispatch_system<system_t, components_t...>(0, {}, uniforms...);
+}
 
+template <typename system_t>
+void registry::compile_system()
+{
+    _get_or_create_system_kernel<system_t>();
+}
+
+template <typename system_t>
+profiling_statistics registry::get_system_statistics() const
+{
+    return _get_profiler()->get_statistics(typeid(system_t).name());
+}
+
+template <typename component_t>
+profiling_statistics registry::get_component_statistics() const
+{
+    return _get_profiler()->get_statistics(typeid(component_t).name());
+}
+
+template <typename system_t, typename... components_t, typename... uniforms_t>
+future<void> registry::_dispatch_system(std::size_t queue_idx, const std::vector<event>& wait_list, uniforms_t&&... uniforms)
+{
+    auto _krn = _get_or_create_system_kernel<system_t>();
+    auto _idx = std::size_t { 0 };
+    auto _arg = std::size_t { 0 };
+    if constexpr (sizeof...(components_t) == 0) {
+        (_bind_argument(*_krn, _arg, uniforms, nullptr), ...);
+        return _run_system<system_t>(*_krn, _arg, _next_entity, wait_list, queue_idx);
+    } else {
+        auto _types = std::vector<std::type_index> { std::type_index(typeid(component_type_t<components_t>))... };
+        auto _read_only = detail::get_read_only_components<system_t, components_t...>((std::size_t { 0 } + ... + detail::system_argument<std::decay_t<uniforms_t>>::arguments_count));
+        for (std::size_t _k = 0; _k < _types.size(); ++_k) {
+            if (!_read_only[_k] && _read_only_types.count(_types[_k])) {
+                throw std::runtime_error(std::string("System writes a read-only component: ") + _types[_k].name());
+            }
+        }
+        (_get_or_create_component_store<component_type_t<components_t>>(), ...);
+        for (std::size_t _k = 0; _k < _types.size(); ++_k) {
+            if (!_read_only[_k]) {
+                _component_stores.at(_types[_k]).dirty = true;
+            }
+        }
+        auto& _join = _get_or_update_join(_types);
+        if (_join.count == 0) {
+            return detail::make_ready_future();
+        }
+        if (_join.aligned) {
+            (_get_or_create_component_store<component_type_t<components_t>>()->bind(*_krn, _arg), ...);
+            (_bind_argument(*_krn, _arg, uniforms, _component_stores.at(_types[0]).entities.get()), ...);
+            return _run_system<system_t>(*_krn, _arg, _join.count, wait_list, queue_idx);
+        }
+        (_gather_component<component_type_t<components_t>>(_join, _idx++, queue_idx, wait_list), ...);
+        _idx = 0;
+        (std::static_pointer_cast<compute::component_storage<component_type_t<components_t>>>(_join.packed[_idx++])->bind(*_krn, _arg), ...);
+        if constexpr ((std::is_same_v<std::decay_t<uniforms_t>, entity_ids> || ...)) {
+            _reserve_scratch(_join.entities, _join.count);
+            _run_gather_table(*_component_stores.at(_types[0]).entities, *_join.matches[0], *_join.entities, _join.count, queue_idx, wait_list);
+        }
+        (_bind_argument(*_krn, _arg, uniforms, _join.entities.get()), ...);
+        auto _result = _run_system<system_t>(*_krn, _arg, _join.count, {}, queue_idx);
+        _idx = 0;
+        ((_read_only[_idx] ? void(++_idx) : void(_result = _scatter_component<component_type_t<components_t>>(_join, _idx++, queue_idx))), ...);
+        return _result;
+    }
+}
+
+template <typename system_t>
+future<void> registry::_run_system(compute::kernel& krn, std::size_t idx, std::size_t count, const std::vector<event>& wait_list, std::size_t queue_idx)
+{
+    if constexpr (has_bounds_guard<system_t>::value) {
+        krn.set_arg(idx, static_cast<cl_uint>(count));
+        return krn.run_tuned(count, wait_list, queue_idx);
+    } else {
+        return krn.run({ count }, wait_list, queue_idx);
+    }
+}
+
+template <typename argument_t>
+void registry::_bind_argument(compute::kernel& krn, std::size_t& idx, argument_t&& value, compute::array_buffer<cl_uint>* entities)
+{
+    using value_t = std::decay_t<argument_t>;
+    if constexpr (detail::is_reference_wrapper<value_t>::value) {
+        _bind_argument(krn, idx, value.get(), entities);
+    } else if constexpr (std::is_same_v<value_t, entity_ids>) {
+        if (!entities) {
+            throw std::runtime_error("Entity ids require at least one component");
+        }
+        krn.set_arg(idx++, *entities);
+    } else if constexpr (detail::system_argument<value_t>::arguments_count > 1) {
+        value.bind(krn, idx);
+    } else {
+        krn.set_arg(idx++, value);
+    }
+}
+
+template <typename... components_t>
+future<void> registry::reconcile(spawn_queue<components_t...>& queue)
+{
+    auto _count = std::min(static_cast<std::size_t>(queue._count.fetch().get()), queue._capacity);
+    auto _result = queue._count.set(0u);
+    if (_count == 0) {
+        return _result;
+    }
+    auto _entities = std::vector<entity>(_count);
+    for (auto& _entity : _entities) {
+        _entity = create_entity();
+    }
+    std::apply([&](auto&... values) { ((_result = _spawn_components(values, _entities)), ...); }, queue._values);
+    return _result;
+}
+
+template <typename component_t>
+future<void> registry::_spawn_components(compute::component_storage<component_t>& values, const std::vector<entity>& entities)
+{
+    auto _buffer = _get_or_create_component_store<component_t>();
+    auto _first_idx = _insert_components(_component_stores.at(std::type_index(typeid(component_t))), entities);
+    return _buffer->copy(values, 0, _first_idx, entities.size());
 }
 
 template <typename component_t>
-std::shared_ptr<compute::array_buffer<component_t>> registry::_get_or_create_component_store()
+void registry::declare_read_only()
 {
     auto _type = std::type_index(typeid(component_t));
     if (_component_stores.find(_type) != _component_stores.end()) {
-        return std::static_pointer_cast<compute::array_buffer<component_t>>(_component_stores[_type]);
+        throw std::runtime_error("Component store already exists");
+    }
+    _read_only_types.insert(_type);
+}
+
+template <typename component_t>
+std::shared_ptr<compute::component_storage<component_t>> registry::_get_or_create_component_store()
+{
+    auto _type = std::type_index(typeid(component_t));
+    auto _it = _component_stores.find(_type);
+    if (_it != _component_stores.end()) {
+        return std::static_pointer_cast<compute::component_storage<component_t>>(_it->second.data);
     }
-    auto _buffer = std::make_shared<compute::array_buffer<component_t>>(_context, _capacity);
-    _component_stores[_type] = _buffer;
+    check_component_layout<component_t>(_context);
+    auto _flags = _read_only_types.count(_type) ? CL_MEM_READ_ONLY : CL_MEM_READ_WRITE;
+    auto _buffer = std::make_shared<compute::component_storage<component_t>>(_context, _capacity, _flags);
+    _buffer->set_label(typeid(component_t).name());
+    auto& _store = _register_component_store(_type, _buffer);
+    _store.read_only = _flags == CL_MEM_READ_ONLY;
+    _store.move = [_buffer](std::size_t src, std::size_t dst) {
+        return _buffer->copy(*_buffer, src, dst, 1);
+    };
+    _store.resize = [_buffer](std::size_t size) {
+        return _buffer->resize(size);
+    };
+    _store.move_slots = [](registry& reg, component_store& store, std::size_t count) {
+        return reg._move_slots<component_t>(store, count);
+    };
     return _buffer;
 }
 
-}
\ No newline at end of file
+template <typename system_t>
+std::shared_ptr<compute::kernel> registry::_get_or_create_system_kernel()
+{
+    auto _key = std::make_pair(std::type_index(typeid(system_t)), _build_options);
+    auto _it = _system_kernels.find(_key);
+    if (_it != _system_kernels.end()) {
+        return _it->second;
+    }
+    auto _krn = std::make_shared<compute::kernel>(_context, system_t::kernel_source, "smain", _build_options);
+    _krn->set_label(typeid(system_t).name());
+    _system_kernels.emplace(_key, _krn);
+    return _krn;
+}
+
+template <typename buffer_t>
+void registry::_reserve_scratch(std::shared_ptr<buffer_t>& buffer, std::size_t size)
+{
+    // scratch contents never need to survive a reallocation, so grow by replacing the buffer
+    if (!buffer || buffer->get_size() < size) {
+        auto _size = buffer ? std::max(size, buffer->get_size() * 2) : std::max(size, _capacity);
+        buffer = std::make_shared<buffer_t>(_context, _size);
+    }
+}
+
+template <typename component_t>
+std::size_t registry::_get_copy_words()
+{
+    if constexpr (sizeof(component_t) % sizeof(cl_uint) == 0) {
+        return sizeof(component_t) / sizeof(cl_uint);
+    } else {
+        return sizeof(component_t);
+    }
+}
+
+template <typename component_t>
+std::string registry::_get_copy_options()
+{
+    auto _element = std::string(sizeof(component_t) % sizeof(cl_uint) == 0 ? "uint" : "uchar");
+    return "-D CLECS_ELEMENT=" + _element + " -D CLECS_ELEMENT_COUNT=" + std::to_string(_get_copy_words<component_t>());
+}
+
+template <typename component_t>
+future<void> registry::_copy_slots(const std::string& name, compute::component_storage<component_t>& src, compute::component_storage<component_t>& dst, compute::array_buffer<cl_uint>& slots, std::size_t count, std::size_t queue_idx, const std::vector<event>& wait_list)
+{
+    auto _result = detail::make_ready_future();
+    if (count == 0) {
+        return _result;
+    }
+    src.for_each_column(dst, [&](auto& src_column, auto& dst_column) {
+        using column_t = typename std::decay_t<decltype(src_column)>::value_type;
+        auto _krn = _get_or_create_builtin_kernel(name, _get_copy_options<column_t>());
+        _krn->set_label(name + " " + typeid(component_t).name());
+        _krn->set_arg(0, src_column);
+        _krn->set_arg(1, dst_column);
+        _krn->set_arg(2, slots);
+        _result = _krn->run({ count * _get_copy_words<column_t>() }, wait_list, queue_idx);
+    });
+    return _result;
+}
+
+template <typename component_t>
+future<void> registry::_move_slots(component_store& store, std::size_t count)
+{
+    // sources and destinations never overlap, so every move can run in parallel
+    auto _buffer = std::static_pointer_cast<compute::component_storage<component_t>>(store.data);
+    auto _staging = std::static_pointer_cast<compute::component_storage<component_t>>(store.staging);
+    _reserve_scratch(_staging, count);
+    store.staging = _staging;
+    _copy_slots<component_t>("clecs_gather", *_buffer, *_staging, *_command_sources, count);
+    return _copy_slots<component_t>("clecs_scatter", *_staging, *_buffer, *_command_destinations, count);
+}
+
+template <typename component_t>
+future<void> registry::_add_components(const std::vector<entity>& entities, std::vector<component_t>&& values)
+{
+    if (entities.empty()) {
+        return detail::make_ready_future();
+    }
+    auto _buffer = _get_or_create_component_store<component_t>();
+    auto& _store = _component_stores.at(std::type_index(typeid(component_t)));
+    auto _first_idx = _insert_components(_store, entities);
+    return _buffer->set(_first_idx, std::move(values));
+}
+
+template <typename component_t>
+future<void> registry::_set_components(const std::vector<entity>& entities, std::vector<component_t>&& values)
+{
+    auto _it = _component_stores.find(std::type_index(typeid(component_t)));
+    if (_it == _component_stores.end()) {
+        throw std::runtime_error("Component not found for entity");
+    }
+    // concurrent writes to the same slot are undefined, so only the last value of a slot is kept
+    auto _positions = std::unordered_map<std::size_t, std::size_t> {};
+    auto _slots = std::vector<cl_uint> {};
+    auto _values = std::vector<component_t> {};
+    for (std::size_t _k = 0; _k < entities.size(); ++_k) {
+        auto _slot = _it->second.entity_slots.find(_get_alive_index(entities[_k]));
+        if (_slot == _it->second.entity_slots.end()) {
+            throw std::runtime_error("Component not found for entity");
+        }
+        auto _position = _positions.emplace(_slot->second, _slots.size());
+        if (_position.second) {
+            _slots.push_back(static_cast<cl_uint>(_slot->second));
+            _values.push_back(std::move(values[_k]));
+        } else {
+            _values[_position.first->second] = std::move(values[_k]);
+        }
+    }
+    if (_slots.empty()) {
+        return detail::make_ready_future();
+    }
+    auto _count = _slots.size();
+    auto _buffer = std::static_pointer_cast<compute::component_storage<component_t>>(_it->second.data);
+    _it->second.dirty = true;
+    if (_it->second.read_only) {
+        // kernels cannot write read-only buffers, so updates are written by the host one slot at a time
+        auto _result = detail::make_ready_future();
+        for (std::size_t _k = 0; _k < _count; ++_k) {
+            _result = _buffer->set(_slots[_k], _values[_k]);
+        }
+        return _result;
+    }
+    auto _staging = std::static_pointer_cast<compute::component_storage<component_t>>(_it->second.staging);
+    _reserve_scratch(_staging, _count);
+    _it->second.staging = _staging;
+    _reserve_scratch(_command_indices, _count);
+    _command_indices->set(0, std::move(_slots));
+    _staging->set(0, std::move(_values));
+    return _copy_slots<component_t>("clecs_scatter", *_staging, *_buffer, *_command_indices, _count);
+}
+
+template <typename component_t>
+future<void> registry::_gather_component(component_join& join, std::size_t idx, std::size_t queue_idx, const std::vector<event>& wait_list)
+{
+    if (join.packed.size() <= idx) {
+        join.packed.resize(idx + 1);
+    }
+    auto _packed = std::static_pointer_cast<compute::component_storage<component_t>>(join.packed[idx]);
+    _reserve_scratch(_packed, join.count);
+    join.packed[idx] = _packed;
+    return _copy_slots<component_t>("clecs_gather", *_get_or_create_component_store<component_t>(), *_packed, *join.matches[idx], join.count, queue_idx, wait_list);
+}
+
+template <typename component_t>
+future<void> registry::_scatter_component(component_join& join, std::size_t idx, std::size_t queue_idx)
+{
+    auto _packed = std::static_pointer_cast<compute::component_storage<component_t>>(join.packed[idx]);
+    return _copy_slots<component_t>("clecs_scatter", *_packed, *_get_or_create_component_store<component_t>(), *join.matches[idx], join.count, queue_idx);
+}
+
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <compute/core/context.hpp>
+#include <compute/ecs/entity.hpp>
+#include <compute/ecs/registry.hpp>
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace compute {
+
+/// @brief ECS registry partitioning its entities across several devices.
+/// The `sharded_registry` owns one `registry` per context, called a shard, and places every
+/// new entity on the shard holding the fewest entities. Each entity and all its components
+/// live on a single shard, so systems run on every shard independently: dispatches are
+/// enqueued on all the shards before any of them is waited for, and the devices process
+/// their part of the entities concurrently. Fetches gather the results of every shard and
+/// translate shard entities back to the handles returned by `create_entity`. Contexts can
+/// target different devices, or sub-devices of the same device. Since shards live in
+/// different OpenCL contexts, the futures returned by the sharded registry join the work
+/// of every shard on the host, and their events are empty. Sharded registries are
+/// non-copyable but movable.
+struct sharded_registry {
+
+    sharded_registry(const sharded_registry& other) = delete;
+    sharded_registry& operator=(const sharded_registry& other) = delete;
+    sharded_registry(sharded_registry&& other) noexcept = default;
+    sharded_registry& operator=(sharded_registry&& other) noexcept = default;
+
+    /// @brief Constructs a sharded registry with one shard per context.
+    /// Throws std::invalid_argument if no context is provided.
+    /// @param contexts The contexts of the shards. They must outlive the registry.
+    /// @param capacity Initially allocated number of entities/components of every shard (default: 1024).
+    /// @param options Build options used when compiling system kernels (can be empty).
+    sharded_registry(const std::vector<std::reference_wrapper<const context>>& contexts, std::size_t capacity = 1024, const std::string& options = "");
+
+    /// @brief Creates a new entity on the shard holding the fewest entities.
+    /// @return A unique entity handle.
+    [[nodiscard]] entity create_entity();
+
+    /// @brief Destroys an entity and removes all its components from its shard.
+    /// Throws std::runtime_error if the entity is not alive.
+    /// @param e The entity to destroy.
+    /// @return A future resolving once the component stores of the shard have been compacted.
+    future<void> destroy_entity(entity e);
+
+    /// @brief Returns whether an entity handle refers to a living entity.
+    /// @param e The entity handle to check.
+    /// @return `true` if the entity was created and has not been destroyed since.
+    [[nodiscard]] bool is_alive(entity e) const;
+
+    /// @brief Adds a component to the given entity on its shard.
+    /// Throws std::runtime_error if the entity is not alive.
+    /// @tparam component_t The type of component being added.
+    /// @param e The target entity.
+    /// @param value The value to assign to this entity's component.
+    template <typename component_t>
+    future<void> add_component(entity e, const component_t& value);
+
+    /// @brief Adds the same component type to a batch of entities.
+    /// Entities are grouped by shard, so that every shard receives a single batch.
+    /// Entities and values are matched by position.
+    /// @tparam component_t The type of component being added.
+    /// @param entities The target entities.
+    /// @param values The values to assign to each entity's component.
+    /// @return A future resolving once every shard has received its batch.
+    template <typename component_t>
+    future<void> add_components(const std::vector<entity>& entities, const std::vector<component_t>& values);
+
+    /// @brief Asynchronously retrieves a component's value from the shard of an entity.
+    /// @tparam component_t The component type to fetch.
+    /// @param e The entity whose component should be fetched.
+    /// @return A future resolving to the component value.
+    template <typename component_t>
+    [[nodiscard]] future<component_t> get_component(entity e);
+
+    /// @brief Removes a component from the given entity on its shard.
+    /// Throws std::runtime_error if the entity is not alive or does not have this component.
+    /// @tparam component_t The type of component being removed.
+    /// @param e The target entity.
+    template <typename component_t>
+    future<void> remove_component(entity e);
+
+    /// @brief Fetches the components that changed on every shard since the previous call.
+    /// Behaves like `registry::fetch_changed` on every shard, and merges the results with
+    /// the entities translated back to the handles of this registry. Blocks while the
+    /// changes of every shard are read back, one shard after another.
+    /// @tparam component_t The component type to fetch.
+    /// @return A ready future holding the changed entities and their component values.
+    template <typename component_t>
+    [[nodiscard]] future<std::vector<std::pair<entity, component_t>>> fetch_changed();
+
+    /// @brief Executes a system on every shard.
+    /// Behaves like `registry::execute_system` on every shard. The dispatches of all the shards
+    /// are enqueued before waiting for any of them. Uniform values are passed to every shard;
+    /// `entity_ids` and queues are not supported, since they refer to a single shard.
+    /// @tparam system_t The generated system type to execute.
+    /// @tparam components_t The component types the system operates on.
+    /// @param uniforms Trivially copyable values matching the trailing kernel parameters.
+    /// @return A future resolving once the system has completed on every shard.
+    template <typename system_t, typename... components_t, typename... uniforms_t>
+    future<void> execute_system(const uniforms_t&... uniforms);
+
+    /// @brief Compiles and caches the kernel of a system on every shard ahead of time.
+    /// @tparam system_t The generated system type to compile.
+    template <typename system_t>
+    void compile_system();
+
+    /// @brief Runs a pipeline of systems several times back to back on every shard.
+    /// Behaves like `registry::step` on every shard, enqueuing all the steps of a shard
+    /// before moving to the next one, so that the devices run their steps concurrently.
+    /// Like `execute_system`, systems of the pipeline only accept uniform values.
+    /// Throws std::invalid_argument if a system of the pipeline takes `entity_ids` or a queue.
+    /// @param steps Number of times the whole pipeline is enqueued.
+    /// @param pl The systems to run at every step, in order.
+    /// @return A future resolving once the last step has completed on every shard.
+    future<void> step(std::size_t steps, const pipeline& pl);
+
+    /// @brief Returns the number of shards.
+    [[nodiscard]] std::size_t get_shards_count() const;
+
+    /// @brief Returns the index of the shard holding an entity.
+    /// Throws std::runtime_error if the entity is not alive.
+    /// @param e The entity to locate.
+    [[nodiscard]] std::size_t get_shard_index(entity e) const;
+
+    /// @brief Returns the registry of a shard, for operations not exposed by the sharded registry.
+    /// Entities of a shard registry are distinct from the handles of the sharded registry.
+    /// Throws std::out_of_range if the shard index is greater than the number of shards.
+    /// @param idx Index of the shard.
+    [[nodiscard]] registry& get_shard(std::size_t idx);
+
+private:
+    struct sharded_entity {
+        std::size_t shard = 0;
+        entity local = 0;
+    };
+    std::vector<std::unique_ptr<registry>> _shards;
+    std::vector<std::size_t> _shard_sizes;
+    std::vector<std::vector<entity>> _shard_entities;
+    std::uint32_t _next_entity;
+    std::vector<std::uint32_t> _entity_versions;
+    std::vector<bool> _entity_alive;
+    std::vector<sharded_entity> _entities;
+    std::vector<std::uint32_t> _free_entities;
+    const sharded_entity& _get_alive_entity(entity e) const;
+    static future<void> _join_futures(std::vector<future<void>>&& futures);
+};
+
+}
+
+#include "sharded_registry.inl"
@@ -0,0 +1,86 @@
+namespace compute {
+
+template <typename component_t>
+future<void> sharded_registry::add_component(entity e, const component_t& value)
+{
+    const auto& _entity = _get_alive_entity(e);
+    return _shards[_entity.shard]->add_component(_entity.local, value);
+}
+
+template <typename component_t>
+future<void> sharded_registry::add_components(const std::vector<entity>& entities, const std::vector<component_t>& values)
+{
+    if (entities.size() != values.size()) {
+        throw std::invalid_argument("Entities and component values must have the same size");
+    }
+    auto _entities = std::vector<std::vector<entity>>(_shards.size());
+    auto _values = std::vector<std::vector<component_t>>(_shards.size());
+    for (std::size_t _k = 0; _k < entities.size(); ++_k) {
+        const auto& _entity = _get_alive_entity(entities[_k]);
+        _entities[_entity.shard].push_back(_entity.local);
+        _values[_entity.shard].push_back(values[_k]);
+    }
+    auto _futures = std::vector<future<void>> {};
+    for (std::size_t _s = 0; _s < _shards.size(); ++_s) {
+        if (!_entities[_s].empty()) {
+            _futures.push_back(_shards[_s]->add_components(_entities[_s], _values[_s]));
+        }
+    }
+    return _join_futures(std::move(_futures));
+}
+
+template <typename component_t>
+future<component_t> sharded_registry::get_component(entity e)
+{
+    const auto& _entity = _get_alive_entity(e);
+    return _shards[_entity.shard]->template get_component<component_t>(_entity.local);
+}
+
+template <typename component_t>
+future<void> sharded_registry::remove_component(entity e)
+{
+    const auto& _entity = _get_alive_entity(e);
+    return _shards[_entity.shard]->template remove_component<component_t>(_entity.local);
+}
+
+template <typename component_t>
+future<std::vector<std::pair<entity, component_t>>> sharded_registry::fetch_changed()
+{
+    // registry::fetch_changed blocks on its readback, so the shards are read back one after another
+    auto _fetched = std::vector<future<std::vector<std::pair<entity, component_t>>>> {};
+    for (auto& _shard : _shards) {
+        _fetched.push_back(_shard->template fetch_changed<component_t>());
+    }
+    auto _merged = std::vector<std::pair<entity, component_t>> {};
+    for (std::size_t _s = 0; _s < _shards.size(); ++_s) {
+        auto _changes = _fetched[_s].get();
+        _merged.reserve(_merged.size() + _changes.size());
+        for (auto& _change : _changes) {
+            _merged.emplace_back(_shard_entities[_s][get_entity_index(_change.first)], std::move(_change.second));
+        }
+    }
+    auto _promise = std::promise<std::vector<std::pair<entity, component_t>>> {};
+    _promise.set_value(std::move(_merged));
+    return future<std::vector<std::pair<entity, component_t>>>(_promise.get_future(), event {});
+}
+
+template <typename system_t, typename... components_t, typename... uniforms_t>
+future<void> sharded_registry::execute_system(const uniforms_t&... uniforms)
+{
+    static_assert(((!std::is_same_v<uniforms_t, entity_ids> && detail::system_argument<uniforms_t>::arguments_count == 1) && ...), "Sharded systems only accept uniform values");
+    auto _futures = std::vector<future<void>> {};
+    for (auto& _shard : _shards) {
+        _futures.push_back(_shard->template execute_system<system_t, components_t...>(uniforms...));
+    }
+    return _join_futures(std::move(_futures));
+}
+
+template <typename system_t>
+void sharded_registry::compile_system()
+{
+    for (auto& _shard : _shards) {
+        _shard->template compile_system<system_t>();
+    }
+}
+
+}
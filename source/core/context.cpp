@@ -4,7 +4,7 @@
 
 namespace compute {
 
-context::context(const device& dev, const std::vector<cl_context_properties>& props)
+context::context(const device& dev, const std::vector<cl_context_properties>& props, cl_command_queue_properties queue_props, std::size_t queues_count)
     : _device(dev._device)
 {
     auto _err = 0;
@@ -14,15 +14,33 @@ context::context(const device& dev, const std::vector<cl_context_properties>& pr
     if (_err != CL_SUCCESS || !_context) {
         throw std::runtime_error("Failed to create OpenCL context.");
     }
-    _queue = clCreateCommandQueue(_context, _device, 0, &_err);
+    _queue = clCreateCommandQueue(_context, _device, queue_props, &_err);
     if (_err != CL_SUCCESS || !_queue) {
         clReleaseContext(_context);
         throw std::runtime_error("Failed to create OpenCL command queue.");
     }
+    for (std::size_t _k = 1; _k < queues_count; ++_k) {
+        auto _concurrent_queue = clCreateCommandQueue(_context, _device, queue_props, &_err);
+        if (_err != CL_SUCCESS || !_concurrent_queue) {
+            for (auto _created : _concurrent_queues) {
+                clReleaseCommandQueue(_created);
+            }
+            clReleaseCommandQueue(_queue);
+            clReleaseContext(_context);
+            throw std::runtime_error("Failed to create OpenCL command queue.");
+        }
+        _concurrent_queues.push_back(_concurrent_queue);
+    }
+    if (queue_props & CL_QUEUE_PROFILING_ENABLE) {
+        _profiler = std::make_shared<profiler>();
+    }
 }
 
 context::~context()
 {
+    for (auto _concurrent_queue : _concurrent_queues) {
+        clReleaseCommandQueue(_concurrent_queue);
+    }
     if (_queue) {
         clReleaseCommandQueue(_queue);
     }
@@ -35,7 +53,11 @@ context::context(context&& other) noexcept
     : _device(other._device)
     , _context(other._context)
     , _queue(other._queue)
+    , _concurrent_queues(std::move(other._concurrent_queues))
+    , _program_cache(std::move(other._program_cache))
+    , _profiler(std::move(other._profiler))
 {
+    other._concurrent_queues.clear();
     other._context = nullptr;
     other._queue = nullptr;
 }
@@ -43,6 +65,9 @@ context::context(context&& other) noexcept
 context& context::operator=(context&& other) noexcept
 {
     if (this != &other) {
+        for (auto _concurrent_queue : _concurrent_queues) {
+            clReleaseCommandQueue(_concurrent_queue);
+        }
         if (_queue) {
             clReleaseCommandQueue(_queue);
         }
@@ -52,10 +77,49 @@ context& context::operator=(context&& other) noexcept
         _device = other._device;
         _context = other._context;
         _queue = other._queue;
+        _concurrent_queues = std::move(other._concurrent_queues);
+        other._concurrent_queues.clear();
+        _program_cache = std::move(other._program_cache);
+        _profiler = std::move(other._profiler);
         other._context = nullptr;
         other._queue = nullptr;
     }
     return *this;
 }
 
+void context::set_program_cache(const std::shared_ptr<program_cache>& cache)
+{
+    _program_cache = cache;
+}
+
+std::shared_ptr<program_cache> context::get_program_cache() const
+{
+    return _program_cache;
+}
+
+std::shared_ptr<profiler> context::get_profiler() const
+{
+    return _profiler;
+}
+
+std::size_t context::get_queues_count() const
+{
+    return 1 + _concurrent_queues.size();
+}
+
+future<void> context::barrier(const std::vector<event>& wait_list, std::size_t queue_idx) const
+{
+    if (queue_idx >= get_queues_count()) {
+        throw std::out_of_range("Queue index out of bounds");
+    }
+    auto _target = queue_idx == 0 ? _queue : _concurrent_queues[queue_idx - 1];
+    auto _waits = native_events(wait_list);
+    auto _evt = cl_event {};
+    auto _err = clEnqueueBarrierWithWaitList(_target, _waits.size(), _waits.data(), &_evt);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to enqueue barrier.");
+    }
+    return detail::make_future<void>(_target, _evt, []() {});
+}
+
 }
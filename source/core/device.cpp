@@ -10,27 +10,43 @@ device::device(const cl_platform_id plat, const cl_device_id dev)
 {
     _platform = plat;
     _device = dev;
+    _sub_device = false;
 }
 
 device::device(device&& other) noexcept
     : _platform(other._platform)
     , _device(other._device)
+    , _sub_device(other._sub_device)
 {
     other._platform = nullptr;
     other._device = nullptr;
+    other._sub_device = false;
 }
 
 device& device::operator=(device&& other) noexcept
 {
     if (this != &other) {
+        if (_sub_device && _device) {
+            clReleaseDevice(_device);
+        }
         _platform = other._platform;
         _device = other._device;
+        _sub_device = other._sub_device;
         other._platform = nullptr;
         other._device = nullptr;
+        other._sub_device = false;
     }
     return *this;
 }
 
+device::~device()
+{
+    // root devices are owned by the platform, only sub-devices are reference counted
+    if (_sub_device && _device) {
+        clReleaseDevice(_device);
+    }
+}
+
 std::size_t device::get_devices_count()
 {
     auto _num_platforms = 0u;
@@ -98,4 +114,58 @@ std::string device::get_name() const
     return std::string(_name.data());
 }
 
+std::size_t device::get_compute_units() const
+{
+    if (!_device) {
+        throw std::runtime_error("Invalid OpenCL device.");
+    }
+    auto _compute_units = cl_uint { 0 };
+    auto _err = clGetDeviceInfo(_device, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(_compute_units), &_compute_units, nullptr);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to get OpenCL device compute units.");
+    }
+    return static_cast<std::size_t>(_compute_units);
+}
+
+bool device::is_sub_device() const
+{
+    return _sub_device;
+}
+
+std::vector<device> device::partition_by_affinity(cl_device_affinity_domain domain) const
+{
+    return _partition({ CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN, static_cast<cl_device_partition_property>(domain), 0 });
+}
+
+std::vector<device> device::partition_equally(std::size_t compute_units) const
+{
+    if (compute_units == 0) {
+        throw std::invalid_argument("Sub-devices require at least one compute unit.");
+    }
+    return _partition({ CL_DEVICE_PARTITION_EQUALLY, static_cast<cl_device_partition_property>(compute_units), 0 });
+}
+
+std::vector<device> device::_partition(const std::vector<cl_device_partition_property>& props) const
+{
+    if (!_device) {
+        throw std::runtime_error("Invalid OpenCL device.");
+    }
+    auto _num_devices = 0u;
+    auto _err = clCreateSubDevices(_device, props.data(), 0, nullptr, &_num_devices);
+    if (_err != CL_SUCCESS || _num_devices == 0) {
+        throw std::runtime_error("Failed to partition OpenCL device.");
+    }
+    auto _devs = std::vector<cl_device_id>(_num_devices);
+    _err = clCreateSubDevices(_device, props.data(), _num_devices, _devs.data(), nullptr);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to create OpenCL sub-devices.");
+    }
+    auto _sub_devices = std::vector<device> {};
+    for (const auto& _dev : _devs) {
+        auto& _sub_device = _sub_devices.emplace_back(_platform, _dev);
+        _sub_device._sub_device = true;
+    }
+    return _sub_devices;
+}
+
 }
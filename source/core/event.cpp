@@ -0,0 +1,117 @@
+#include <compute/core/event.hpp>
+
+namespace compute {
+
+event::event()
+    : _event(nullptr)
+{
+}
+
+event::event(cl_event evt)
+    : _event(evt)
+{
+}
+
+event::event(const event& other)
+    : _event(other._event)
+{
+    if (_event) {
+        clRetainEvent(_event);
+    }
+}
+
+event& event::operator=(const event& other)
+{
+    if (this != &other) {
+        if (other._event) {
+            clRetainEvent(other._event);
+        }
+        if (_event) {
+            clReleaseEvent(_event);
+        }
+        _event = other._event;
+    }
+    return *this;
+}
+
+event::event(event&& other) noexcept
+    : _event(other._event)
+{
+    other._event = nullptr;
+}
+
+event& event::operator=(event&& other) noexcept
+{
+    if (this != &other) {
+        if (_event) {
+            clReleaseEvent(_event);
+        }
+        _event = other._event;
+        other._event = nullptr;
+    }
+    return *this;
+}
+
+event::~event()
+{
+    if (_event) {
+        clReleaseEvent(_event);
+    }
+}
+
+void event::wait() const
+{
+    if (!_event) {
+        return;
+    }
+    auto _err = clWaitForEvents(1, &_event);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to wait for OpenCL event");
+    }
+}
+
+bool event::is_complete() const
+{
+    if (!_event) {
+        return true;
+    }
+    auto _status = cl_int {};
+    auto _err = clGetEventInfo(_event, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(cl_int), &_status, nullptr);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to query OpenCL event status");
+    }
+    return _status == CL_COMPLETE;
+}
+
+native_events::native_events(const std::vector<event>& events)
+{
+    _events.reserve(events.size());
+    for (const auto& _evt : events) {
+        if (_evt._event) {
+            _events.push_back(_evt._event);
+        }
+    }
+}
+
+cl_uint native_events::size() const
+{
+    return static_cast<cl_uint>(_events.size());
+}
+
+const cl_event* native_events::data() const
+{
+    return _events.empty() ? nullptr : _events.data();
+}
+
+namespace detail {
+
+    future<void> make_ready_future()
+    {
+        auto _promise = std::promise<void> {};
+        _promise.set_value();
+        return future<void>(_promise.get_future(), event());
+    }
+
+}
+
+}
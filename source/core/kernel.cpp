@@ -1,49 +1,125 @@
 #include <compute/core/kernel.hpp>
 
+#include <algorithm>
+#include <limits>
 #include <stdexcept>
 
 namespace compute {
 
-kernel::kernel(const context& ctx, const std::string& code, const std::string& name)
+namespace {
+
+    // number of dispatches timed with each candidate local size before picking the fastest
+    constexpr std::size_t tuning_samples = 3;
+
+    std::size_t get_tuning_bucket(std::size_t count)
+    {
+        auto _bucket = std::size_t { 1 };
+        while (_bucket < count) {
+            _bucket <<= 1;
+        }
+        return _bucket;
+    }
+
+}
+
+kernel::kernel(const context& ctx, const std::string& code, const std::string& name, const std::string& options)
     : _device(ctx._device)
     , _context(ctx._context)
-    , _command_queue(ctx._queue)
+    , _command_queues(1, ctx._queue)
+    , _program(nullptr)
+    , _profiler(ctx._profiler)
+    , _label(name)
+    , _cache(ctx._program_cache)
 {
+    _command_queues.insert(_command_queues.end(), ctx._concurrent_queues.begin(), ctx._concurrent_queues.end());
     auto _err = 0;
-    auto* _source = code.c_str();
-    auto _length = code.length();
-    _program = clCreateProgramWithSource(_context, 1, &_source, &_length, &_err);
-    if (_err != CL_SUCCESS) {
-        throw std::runtime_error("Failed to create OpenCL program.");
+    auto _cache = ctx._program_cache;
+    auto _cache_path = std::filesystem::path {};
+    if (_cache) {
+        _cache_path = _cache->_get_path(_device, code, options);
+        auto _binary = std::vector<unsigned char> {};
+        if (_cache->_load(_cache_path, _binary)) {
+            const auto* _binary_data = _binary.data();
+            auto _binary_size = _binary.size();
+            auto _binary_status = 0;
+            _program = clCreateProgramWithBinary(_context, 1, &_device, &_binary_size, &_binary_data, &_binary_status, &_err);
+            if (_err != CL_SUCCESS || _binary_status != CL_SUCCESS) {
+                if (_program) {
+                    clReleaseProgram(_program);
+                }
+                _program = nullptr;
+            } else if (clBuildProgram(_program, 1, &_device, options.c_str(), nullptr, nullptr) != CL_SUCCESS) {
+                clReleaseProgram(_program);
+                _program = nullptr;
+            }
+        }
+        if (_program) {
+            ++_cache->_hits;
+        } else {
+            ++_cache->_misses;
+        }
     }
-    _err = clBuildProgram(_program, 1, &_device, nullptr, nullptr, nullptr);
-    if (_err != CL_SUCCESS) {
-        auto _log_size = static_cast<std::size_t>(0);
-        clGetProgramBuildInfo(_program, _device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &_log_size);
-        auto _build_log = std::string(_log_size, '\0');
-        clGetProgramBuildInfo(_program, _device, CL_PROGRAM_BUILD_LOG, _log_size, &_build_log[0], nullptr);
-        clReleaseProgram(_program);
-        throw std::runtime_error("Failed to build OpenCL program:\n" + _build_log);
+    if (!_program) {
+        auto* _source = code.c_str();
+        auto _length = code.length();
+        _program = clCreateProgramWithSource(_context, 1, &_source, &_length, &_err);
+        if (_err != CL_SUCCESS) {
+            throw std::runtime_error("Failed to create OpenCL program.");
+        }
+        _err = clBuildProgram(_program, 1, &_device, options.c_str(), nullptr, nullptr);
+        if (_err != CL_SUCCESS) {
+            auto _log_size = static_cast<std::size_t>(0);
+            clGetProgramBuildInfo(_program, _device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &_log_size);
+            auto _build_log = std::string(_log_size, '\0');
+            clGetProgramBuildInfo(_program, _device, CL_PROGRAM_BUILD_LOG, _log_size, &_build_log[0], nullptr);
+            clReleaseProgram(_program);
+            throw std::runtime_error("Failed to build OpenCL program:\n" + _build_log);
+        }
+        if (_cache) {
+            auto _binary_size = static_cast<std::size_t>(0);
+            _err = clGetProgramInfo(_program, CL_PROGRAM_BINARY_SIZES, sizeof(std::size_t), &_binary_size, nullptr);
+            if (_err == CL_SUCCESS && _binary_size > 0) {
+                auto _binary = std::vector<unsigned char>(_binary_size);
+                auto* _binary_data = _binary.data();
+                _err = clGetProgramInfo(_program, CL_PROGRAM_BINARIES, sizeof(unsigned char*), &_binary_data, nullptr);
+                if (_err == CL_SUCCESS) {
+                    _cache->_store(_cache_path, _binary);
+                }
+            }
+        }
     }
     _kernel = clCreateKernel(_program, name.c_str(), &_err);
     if (_err != CL_SUCCESS) {
         clReleaseProgram(_program);
         throw std::runtime_error("Failed to create OpenCL kernel.");
     }
+    if (_cache) {
+        _work_groups_path = _cache->_get_work_groups_path(_cache_path, name);
+        auto _local_sizes = std::map<std::size_t, std::size_t> {};
+        _cache->_load_work_groups(_work_groups_path, _local_sizes);
+        for (const auto& _entry : _local_sizes) {
+            _tunings[_entry.first].local_size = _entry.second;
+        }
+    }
 }
 
 kernel::kernel(kernel&& other) noexcept
     : _device(other._device)
     , _context(other._context)
-    , _command_queue(other._command_queue)
+    , _command_queues(std::move(other._command_queues))
     , _program(other._program)
     , _kernel(other._kernel)
+    , _profiler(std::move(other._profiler))
+    , _label(std::move(other._label))
+    , _cache(std::move(other._cache))
+    , _work_groups_path(std::move(other._work_groups_path))
+    , _tunings(std::move(other._tunings))
 {
     other._program = nullptr;
     other._kernel = nullptr;
     other._device = nullptr;
     other._context = nullptr;
-    other._command_queue = nullptr;
+    other._command_queues.clear();
 }
 
 kernel& kernel::operator=(kernel&& other) noexcept
@@ -57,12 +133,17 @@ kernel& kernel::operator=(kernel&& other) noexcept
         }
         _device = other._device;
         _context = other._context;
-        _command_queue = other._command_queue;
+        _command_queues = std::move(other._command_queues);
         _program = other._program;
         _kernel = other._kernel;
+        _profiler = std::move(other._profiler);
+        _label = std::move(other._label);
+        _cache = std::move(other._cache);
+        _work_groups_path = std::move(other._work_groups_path);
+        _tunings = std::move(other._tunings);
         other._device = nullptr;
         other._context = nullptr;
-        other._command_queue = nullptr;
+        other._command_queues.clear();
         other._program = nullptr;
         other._kernel = nullptr;
     }
@@ -79,19 +160,138 @@ kernel::~kernel()
     }
 }
 
-std::future<void> kernel::run(const std::vector<std::size_t>& wsz)
+future<void> kernel::run(const std::vector<std::size_t>& wsz, const std::vector<event>& wait_list, std::size_t queue_idx, const std::vector<std::size_t>& lsz)
+{
+    if (wsz.empty()) {
+        throw std::runtime_error("Work size cannot be empty.");
+    }
+    if (!lsz.empty() && lsz.size() != wsz.size()) {
+        throw std::runtime_error("Local work size must have as many dimensions as the global work size.");
+    }
+    if (queue_idx >= _command_queues.size()) {
+        throw std::out_of_range("Queue index out of bounds");
+    }
+    auto _waits = native_events(wait_list);
+    auto _evt = cl_event {};
+    auto _err = clEnqueueNDRangeKernel(_command_queues[queue_idx], _kernel, static_cast<cl_uint>(wsz.size()), nullptr, wsz.data(), lsz.empty() ? nullptr : lsz.data(), _waits.size(), _waits.data(), &_evt);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to enqueue kernel.");
+    }
+    if (_profiler) {
+        _profiler->_track(_evt, _label, "kernel", 0);
+    }
+    return detail::make_future<void>(_command_queues[queue_idx], _evt, []() {});
+}
+
+future<void> kernel::run_tuned(std::size_t count, const std::vector<event>& wait_list, std::size_t queue_idx)
 {
-    return std::async(std::launch::async, [this, wsz]() {
-        auto _global_ws = wsz;
-        if (_global_ws.empty()) {
-            throw std::runtime_error("Work size cannot be empty.");
+    if (count == 0) {
+        throw std::runtime_error("Work size cannot be empty.");
+    }
+    auto& _tuning = _get_or_create_tuning(get_tuning_bucket(count));
+    auto _local_size = _tuning.local_size;
+    auto _candidate = _tuning.candidates.size();
+    if (_local_size == 0 && _profiler) {
+        _collect_samples(_tuning);
+        _local_size = _tuning.local_size;
+        if (_local_size == 0 && _tuning.dispatched < _tuning.candidates.size() * tuning_samples) {
+            _candidate = _tuning.dispatched++ % _tuning.candidates.size();
+            _local_size = _tuning.candidates[_candidate];
         }
-        auto _err = clEnqueueNDRangeKernel(_command_queue, _kernel, static_cast<cl_uint>(_global_ws.size()), nullptr, _global_ws.data(), nullptr, 0, nullptr, nullptr);
-        if (_err != CL_SUCCESS) {
-            throw std::runtime_error("Failed to enqueue kernel.");
+    }
+    if (_local_size == 0) {
+        return run({ count }, wait_list, queue_idx);
+    }
+    auto _global_size = (count + _local_size - 1) / _local_size * _local_size;
+    auto _result = run({ _global_size }, wait_list, queue_idx, { _local_size });
+    if (_candidate < _tuning.candidates.size()) {
+        _tuning.pending.emplace_back(_candidate, _result.get_event());
+    }
+    return _result;
+}
+
+std::size_t kernel::get_max_work_group_size() const
+{
+    auto _size = std::size_t { 0 };
+    auto _err = clGetKernelWorkGroupInfo(_kernel, _device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(_size), &_size, nullptr);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to get OpenCL kernel work-group size.");
+    }
+    return _size;
+}
+
+std::size_t kernel::get_preferred_work_group_multiple() const
+{
+    auto _multiple = std::size_t { 0 };
+    auto _err = clGetKernelWorkGroupInfo(_kernel, _device, CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE, sizeof(_multiple), &_multiple, nullptr);
+    if (_err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to get OpenCL kernel preferred work-group size multiple.");
+    }
+    return _multiple;
+}
+
+std::size_t kernel::get_tuned_local_size(std::size_t count) const
+{
+    auto _it = _tunings.find(get_tuning_bucket(count));
+    return _it == _tunings.end() ? 0 : _it->second.local_size;
+}
+
+void kernel::set_label(const std::string& label)
+{
+    _label = label;
+}
+
+kernel::work_group_tuning& kernel::_get_or_create_tuning(std::size_t bucket)
+{
+    auto _it = _tunings.find(bucket);
+    if (_it != _tunings.end()) {
+        return _it->second;
+    }
+    auto& _tuning = _tunings[bucket];
+    auto _max_size = std::max<std::size_t>(get_max_work_group_size(), 1);
+    auto _multiple = std::min(std::max<std::size_t>(get_preferred_work_group_multiple(), 1), _max_size);
+    // work-groups larger than the bucket would only add padding work-items
+    for (auto _size = _multiple; _size <= _max_size && (_size <= bucket || _size == _multiple); _size *= 2) {
+        _tuning.candidates.push_back(_size);
+    }
+    _tuning.samples.assign(_tuning.candidates.size(), 0);
+    _tuning.durations.assign(_tuning.candidates.size(), std::numeric_limits<cl_ulong>::max());
+    return _tuning;
+}
+
+void kernel::_collect_samples(work_group_tuning& tuning)
+{
+    auto _pending = std::vector<std::pair<std::size_t, event>> {};
+    for (auto& _sample : tuning.pending) {
+        if (!_sample.second.is_complete()) {
+            _pending.push_back(std::move(_sample));
+            continue;
+        }
+        auto _started = cl_ulong { 0 };
+        auto _ended = cl_ulong { 0 };
+        if (clGetEventProfilingInfo(_sample.second._event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &_started, nullptr) == CL_SUCCESS
+            && clGetEventProfilingInfo(_sample.second._event, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &_ended, nullptr) == CL_SUCCESS
+            && _ended >= _started) {
+            // the fastest sample is the least disturbed by other work on the device
+            tuning.durations[_sample.first] = std::min(tuning.durations[_sample.first], _ended - _started);
         }
-        clFinish(_command_queue);
-    });
+        ++tuning.samples[_sample.first];
+    }
+    tuning.pending = std::move(_pending);
+    if (std::any_of(tuning.samples.begin(), tuning.samples.end(), [](std::size_t samples) { return samples < tuning_samples; })) {
+        return;
+    }
+    auto _best = std::min_element(tuning.durations.begin(), tuning.durations.end()) - tuning.durations.begin();
+    tuning.local_size = tuning.candidates[static_cast<std::size_t>(_best)];
+    if (_cache) {
+        auto _local_sizes = std::map<std::size_t, std::size_t> {};
+        for (const auto& _tuning : _tunings) {
+            if (_tuning.second.local_size != 0) {
+                _local_sizes[_tuning.first] = _tuning.second.local_size;
+            }
+        }
+        _cache->_store_work_groups(_work_groups_path, _local_sizes);
+    }
 }
 
 }
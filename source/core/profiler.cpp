@@ -0,0 +1,159 @@
+#include <compute/core/profiler.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace compute {
+
+namespace {
+
+    struct pending_record {
+        std::shared_ptr<profiler> owner;
+        profiling_record record;
+    };
+
+    std::string escape_json(const std::string& str)
+    {
+        auto _escaped = std::string {};
+        for (const auto _c : str) {
+            if (_c == '"' || _c == '\\') {
+                _escaped += '\\';
+            }
+            if (static_cast<unsigned char>(_c) >= 0x20) {
+                _escaped += _c;
+            }
+        }
+        return _escaped;
+    }
+
+}
+
+profiler::profiler()
+    : _pending(0)
+{
+}
+
+std::vector<profiling_record> profiler::get_records() const
+{
+    return _wait_records();
+}
+
+profiling_statistics profiler::get_statistics(const std::string& label) const
+{
+    auto _durations = std::vector<double> {};
+    auto _statistics = profiling_statistics {};
+    for (const auto& _record : _wait_records()) {
+        if (_record.label == label) {
+            _durations.push_back(static_cast<double>(_record.ended - _record.started) * 1e-6);
+            _statistics.bytes += _record.bytes;
+        }
+    }
+    if (_durations.empty()) {
+        return _statistics;
+    }
+    std::sort(_durations.begin(), _durations.end());
+    _statistics.count = _durations.size();
+    _statistics.min_ms = _durations.front();
+    for (const auto _duration : _durations) {
+        _statistics.total_ms += _duration;
+    }
+    _statistics.mean_ms = _statistics.total_ms / static_cast<double>(_durations.size());
+    auto _p99_idx = static_cast<std::size_t>(std::ceil(0.99 * static_cast<double>(_durations.size()))) - 1;
+    _statistics.p99_ms = _durations[_p99_idx];
+    if (_statistics.total_ms > 0) {
+        _statistics.bandwidth_gbps = static_cast<double>(_statistics.bytes) / (_statistics.total_ms * 1e6);
+    }
+    return _statistics;
+}
+
+void profiler::dump_trace(const std::filesystem::path& path) const
+{
+    auto _records = _wait_records();
+    auto _ofs = std::ofstream(path);
+    if (!_ofs.is_open()) {
+        throw std::runtime_error("Failed to open trace file: " + path.string());
+    }
+    auto _origin = std::numeric_limits<cl_ulong>::max();
+    for (const auto& _record : _records) {
+        _origin = std::min(_origin, _record.queued);
+    }
+    auto _categories = std::vector<std::string> {};
+    _ofs << "{\"traceEvents\":[";
+    for (std::size_t _k = 0; _k < _records.size(); ++_k) {
+        const auto& _record = _records[_k];
+        auto _category = std::find(_categories.begin(), _categories.end(), _record.category);
+        if (_category == _categories.end()) {
+            _category = _categories.insert(_categories.end(), _record.category);
+        }
+        auto _label = _record.label.empty() ? std::string("unnamed") : escape_json(_record.label);
+        _ofs << (_k ? ",\n" : "\n");
+        _ofs << "{\"name\":\"" << _label << "\",\"cat\":\"" << escape_json(_record.category) << "\",\"ph\":\"X\"";
+        _ofs << ",\"ts\":" << static_cast<double>(_record.started - _origin) * 1e-3;
+        _ofs << ",\"dur\":" << static_cast<double>(_record.ended - _record.started) * 1e-3;
+        _ofs << ",\"pid\":0,\"tid\":" << (_category - _categories.begin());
+        _ofs << ",\"args\":{\"bytes\":" << _record.bytes;
+        _ofs << ",\"queued_us\":" << static_cast<double>(_record.queued - _origin) * 1e-3;
+        _ofs << ",\"submitted_us\":" << static_cast<double>(_record.submitted - _origin) * 1e-3 << "}}";
+    }
+    for (std::size_t _k = 0; _k < _categories.size(); ++_k) {
+        _ofs << (_records.empty() && _k == 0 ? "\n" : ",\n");
+        _ofs << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << _k << ",\"args\":{\"name\":\"" << escape_json(_categories[_k]) << "\"}}";
+    }
+    _ofs << "\n]}\n";
+}
+
+void profiler::clear()
+{
+    auto _lock = std::unique_lock<std::mutex>(_mutex);
+    _records.clear();
+}
+
+void profiler::_track(cl_event evt, const std::string& label, const std::string& category, std::size_t bytes)
+{
+    auto* _pending_record = new pending_record { shared_from_this(), profiling_record { label, category, bytes, 0, 0, 0, 0 } };
+    {
+        auto _lock = std::unique_lock<std::mutex>(_mutex);
+        ++_pending;
+    }
+    clRetainEvent(evt);
+    if (clSetEventCallback(evt, CL_COMPLETE, &profiler::_on_complete, _pending_record) != CL_SUCCESS) {
+        clReleaseEvent(evt);
+        delete _pending_record;
+        auto _lock = std::unique_lock<std::mutex>(_mutex);
+        --_pending;
+    }
+}
+
+std::vector<profiling_record> profiler::_wait_records() const
+{
+    auto _lock = std::unique_lock<std::mutex>(_mutex);
+    _completed.wait(_lock, [this]() { return _pending == 0; });
+    return _records;
+}
+
+void CL_CALLBACK profiler::_on_complete(cl_event evt, cl_int status, void* user_data)
+{
+    auto* _pending_record = static_cast<pending_record*>(user_data);
+    auto& _record = _pending_record->record;
+    auto _owner = std::move(_pending_record->owner);
+    auto _valid = status == CL_COMPLETE
+        && clGetEventProfilingInfo(evt, CL_PROFILING_COMMAND_QUEUED, sizeof(cl_ulong), &_record.queued, nullptr) == CL_SUCCESS
+        && clGetEventProfilingInfo(evt, CL_PROFILING_COMMAND_SUBMIT, sizeof(cl_ulong), &_record.submitted, nullptr) == CL_SUCCESS
+        && clGetEventProfilingInfo(evt, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &_record.started, nullptr) == CL_SUCCESS
+        && clGetEventProfilingInfo(evt, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &_record.ended, nullptr) == CL_SUCCESS;
+    {
+        auto _lock = std::unique_lock<std::mutex>(_owner->_mutex);
+        if (_valid) {
+            _owner->_records.push_back(std::move(_record));
+        }
+        --_owner->_pending;
+    }
+    _owner->_completed.notify_all();
+    delete _pending_record;
+    clReleaseEvent(evt);
+}
+
+}
@@ -0,0 +1,175 @@
+#include <compute/core/program_cache.hpp>
+
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace compute {
+
+namespace {
+
+    std::string get_device_string(const cl_device_id dev, const cl_device_info info)
+    {
+        auto _size = static_cast<std::size_t>(0u);
+        if (clGetDeviceInfo(dev, info, 0, nullptr, &_size) != CL_SUCCESS || _size == 0) {
+            return {};
+        }
+        auto _value = std::vector<char>(_size);
+        if (clGetDeviceInfo(dev, info, _size, _value.data(), nullptr) != CL_SUCCESS) {
+            return {};
+        }
+        return std::string(_value.data());
+    }
+
+    std::string get_platform_version(const cl_device_id dev)
+    {
+        auto _platform = cl_platform_id {};
+        if (clGetDeviceInfo(dev, CL_DEVICE_PLATFORM, sizeof(cl_platform_id), &_platform, nullptr) != CL_SUCCESS) {
+            return {};
+        }
+        auto _size = static_cast<std::size_t>(0u);
+        if (clGetPlatformInfo(_platform, CL_PLATFORM_VERSION, 0, nullptr, &_size) != CL_SUCCESS || _size == 0) {
+            return {};
+        }
+        auto _value = std::vector<char>(_size);
+        if (clGetPlatformInfo(_platform, CL_PLATFORM_VERSION, _size, _value.data(), nullptr) != CL_SUCCESS) {
+            return {};
+        }
+        return std::string(_value.data());
+    }
+
+    void hash_string(std::uint64_t& hash, const std::string& str)
+    {
+        // FNV-1a, with a separator so that ("ab", "c") and ("a", "bc") differ
+        for (const auto _c : str) {
+            hash ^= static_cast<unsigned char>(_c);
+            hash *= 0x100000001b3ull;
+        }
+        hash ^= 0xffu;
+        hash *= 0x100000001b3ull;
+    }
+
+    void write_file(const std::filesystem::path& path, const char* data, std::size_t size)
+    {
+        // write to a temporary file first so that concurrent processes never load a partial file,
+        // with a random suffix so that processes and threads sharing the cache never write to the same one
+        auto _suffix = std::ostringstream {};
+        _suffix << ".tmp" << std::hex << std::random_device {}() << std::hash<std::thread::id> {}(std::this_thread::get_id());
+        auto _temp_path = path;
+        _temp_path += _suffix.str();
+        auto _err = std::error_code {};
+        {
+            auto _ofs = std::ofstream(_temp_path, std::ios::binary | std::ios::trunc);
+            if (!_ofs.is_open()) {
+                return;
+            }
+            _ofs.write(data, static_cast<std::streamsize>(size));
+            if (!_ofs) {
+                _ofs.close();
+                std::filesystem::remove(_temp_path, _err);
+                return;
+            }
+        }
+        std::filesystem::rename(_temp_path, path, _err);
+        if (_err) {
+            std::filesystem::remove(_temp_path, _err);
+        }
+    }
+
+}
+
+program_cache::program_cache(const std::filesystem::path& directory)
+    : _directory(directory)
+    , _hits(0)
+    , _misses(0)
+{
+    auto _err = std::error_code {};
+    std::filesystem::create_directories(_directory, _err);
+    if (_err) {
+        throw std::runtime_error("Failed to create program cache directory: " + _directory.string());
+    }
+}
+
+const std::filesystem::path& program_cache::get_directory() const
+{
+    return _directory;
+}
+
+std::size_t program_cache::get_hits() const
+{
+    return _hits.load();
+}
+
+std::size_t program_cache::get_misses() const
+{
+    return _misses.load();
+}
+
+std::filesystem::path program_cache::_get_path(const cl_device_id dev, const std::string& code, const std::string& options) const
+{
+    auto _hash = static_cast<std::uint64_t>(0xcbf29ce484222325ull);
+    hash_string(_hash, code);
+    hash_string(_hash, options);
+    hash_string(_hash, get_device_string(dev, CL_DEVICE_NAME));
+    hash_string(_hash, get_device_string(dev, CL_DEVICE_VENDOR));
+    hash_string(_hash, get_device_string(dev, CL_DEVICE_VERSION));
+    hash_string(_hash, get_device_string(dev, CL_DRIVER_VERSION));
+    hash_string(_hash, get_platform_version(dev));
+    auto _oss = std::ostringstream {};
+    _oss << std::hex << std::setw(16) << std::setfill('0') << _hash << ".bin";
+    return _directory / _oss.str();
+}
+
+bool program_cache::_load(const std::filesystem::path& path, std::vector<unsigned char>& binary) const
+{
+    auto _ifs = std::ifstream(path, std::ios::binary | std::ios::ate);
+    if (!_ifs.is_open()) {
+        return false;
+    }
+    auto _size = static_cast<std::streamoff>(_ifs.tellg());
+    if (_size <= 0) {
+        return false;
+    }
+    binary.resize(static_cast<std::size_t>(_size));
+    _ifs.seekg(0);
+    return static_cast<bool>(_ifs.read(reinterpret_cast<char*>(binary.data()), _size));
+}
+
+void program_cache::_store(const std::filesystem::path& path, const std::vector<unsigned char>& binary) const
+{
+    write_file(path, reinterpret_cast<const char*>(binary.data()), binary.size());
+}
+
+std::filesystem::path program_cache::_get_work_groups_path(const std::filesystem::path& binary_path, const std::string& name) const
+{
+    // a program can hold several kernels, each tuned separately
+    auto _path = binary_path;
+    _path.replace_extension("." + name + ".wg");
+    return _path;
+}
+
+void program_cache::_load_work_groups(const std::filesystem::path& path, std::map<std::size_t, std::size_t>& local_sizes) const
+{
+    auto _ifs = std::ifstream(path);
+    auto _bucket = std::size_t { 0 };
+    auto _local_size = std::size_t { 0 };
+    while (_ifs >> _bucket >> _local_size) {
+        local_sizes[_bucket] = _local_size;
+    }
+}
+
+void program_cache::_store_work_groups(const std::filesystem::path& path, const std::map<std::size_t, std::size_t>& local_sizes) const
+{
+    auto _oss = std::ostringstream {};
+    for (const auto& _entry : local_sizes) {
+        _oss << _entry.first << " " << _entry.second << "\n";
+    }
+    auto _str = _oss.str();
+    write_file(path, _str.data(), _str.size());
+}
+
+}
@@ -0,0 +1,144 @@
+#include <compute/core/thread_pool.hpp>
+
+#include <algorithm>
+
+namespace compute {
+
+thread_pool::thread_pool(std::size_t threads_count)
+    : _func(nullptr)
+    , _generation(0)
+    , _remaining(0)
+    , _stopping(false)
+{
+    if (threads_count == 0) {
+        threads_count = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    for (std::size_t _k = 0; _k < threads_count; ++_k) {
+        _queues.push_back(std::make_unique<chunk_queue>());
+    }
+    // the last queue belongs to the thread calling parallel_for
+    for (std::size_t _k = 0; _k + 1 < threads_count; ++_k) {
+        _threads.emplace_back([this, _k]() { _work(_k); });
+    }
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        auto _lock = std::lock_guard<std::mutex>(_mutex);
+        _stopping = true;
+    }
+    _wake.notify_all();
+    for (auto& _thread : _threads) {
+        _thread.join();
+    }
+}
+
+std::size_t thread_pool::get_threads_count() const
+{
+    return _queues.size();
+}
+
+void thread_pool::parallel_for(std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& func)
+{
+    if (count == 0) {
+        return;
+    }
+    auto _loop_lock = std::lock_guard<std::mutex>(_loop_mutex);
+    auto _threads_count = _queues.size();
+    // a few chunks per thread leave room for stealing without shrinking the inner loops
+    auto _chunk = std::max<std::size_t>({ grain, (count + _threads_count * 4 - 1) / (_threads_count * 4), 1 });
+    _chunk = (_chunk + chunk_alignment - 1) / chunk_alignment * chunk_alignment;
+    auto _chunks_count = (count + _chunk - 1) / _chunk;
+    if (_chunks_count == 1 || _threads.empty()) {
+        func(0, count);
+        return;
+    }
+    {
+        auto _lock = std::lock_guard<std::mutex>(_mutex);
+        _func = &func;
+        _remaining = _chunks_count;
+        _exception = nullptr;
+    }
+    for (std::size_t _q = 0; _q < _threads_count; ++_q) {
+        auto& _queue = *_queues[_q];
+        auto _lock = std::lock_guard<std::mutex>(_queue.mutex);
+        for (auto _c = _q * _chunks_count / _threads_count; _c < (_q + 1) * _chunks_count / _threads_count; ++_c) {
+            _queue.chunks.emplace_back(_c * _chunk, std::min(count, (_c + 1) * _chunk));
+        }
+    }
+    {
+        auto _lock = std::lock_guard<std::mutex>(_mutex);
+        ++_generation;
+    }
+    _wake.notify_all();
+    _run_chunks(_threads_count - 1);
+    auto _lock = std::unique_lock<std::mutex>(_mutex);
+    _done.wait(_lock, [this]() { return _remaining == 0; });
+    _func = nullptr;
+    auto _exception_thrown = std::exchange(_exception, nullptr);
+    if (_exception_thrown) {
+        std::rethrow_exception(_exception_thrown);
+    }
+}
+
+void thread_pool::_work(std::size_t idx)
+{
+    auto _seen = std::size_t { 0 };
+    while (true) {
+        {
+            auto _lock = std::unique_lock<std::mutex>(_mutex);
+            _wake.wait(_lock, [&]() { return _stopping || _generation != _seen; });
+            if (_stopping) {
+                return;
+            }
+            _seen = _generation;
+        }
+        _run_chunks(idx);
+    }
+}
+
+void thread_pool::_run_chunks(std::size_t idx)
+{
+    auto _chunk = std::pair<std::size_t, std::size_t> {};
+    while (_pop_chunk(idx, _chunk)) {
+        try {
+            (*_func)(_chunk.first, _chunk.second);
+        } catch (...) {
+            auto _lock = std::lock_guard<std::mutex>(_mutex);
+            if (!_exception) {
+                _exception = std::current_exception();
+            }
+        }
+        auto _lock = std::lock_guard<std::mutex>(_mutex);
+        if (--_remaining == 0) {
+            _done.notify_all();
+        }
+    }
+}
+
+bool thread_pool::_pop_chunk(std::size_t idx, std::pair<std::size_t, std::size_t>& chunk)
+{
+    // own chunks are taken in order for locality, stolen ones from the far end
+    {
+        auto& _queue = *_queues[idx];
+        auto _lock = std::lock_guard<std::mutex>(_queue.mutex);
+        if (!_queue.chunks.empty()) {
+            chunk = _queue.chunks.front();
+            _queue.chunks.pop_front();
+            return true;
+        }
+    }
+    for (std::size_t _k = 1; _k < _queues.size(); ++_k) {
+        auto& _queue = *_queues[(idx + _k) % _queues.size()];
+        auto _lock = std::lock_guard<std::mutex>(_queue.mutex);
+        if (!_queue.chunks.empty()) {
+            chunk = _queue.chunks.back();
+            _queue.chunks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,107 @@
+#include <compute/ecs/archetype_registry.hpp>
+
+#include <algorithm>
+
+namespace compute {
+
+archetype_registry::archetype_registry(const context& ctx, std::size_t chunk_capacity, const std::string& options)
+    : _context(ctx)
+    , _chunk_capacity(chunk_capacity)
+    , _next_entity(0)
+    , _build_options(options)
+{
+    if (_chunk_capacity == 0) {
+        throw std::invalid_argument("Chunk capacity cannot be zero");
+    }
+}
+
+entity archetype_registry::create_entity()
+{
+    return entity { _next_entity++ };
+}
+
+std::size_t archetype_registry::get_archetypes_count() const
+{
+    return _archetypes.size();
+}
+
+archetype_registry::location archetype_registry::_move_entity(entity e, const std::type_index& added)
+{
+    if (e >= _next_entity) {
+        throw std::runtime_error("Invalid entity");
+    }
+    auto _signature = std::vector<std::type_index> {};
+    auto _it = _locations.find(e);
+    if (_it != _locations.end()) {
+        _signature = _it->second.arch->signature;
+        if (std::find(_signature.begin(), _signature.end(), added) != _signature.end()) {
+            throw std::runtime_error("Component already added to entity");
+        }
+    }
+    _signature.push_back(added);
+    std::sort(_signature.begin(), _signature.end());
+    auto& _archetype = _archetypes[_signature];
+    if (_archetype.signature.empty()) {
+        _archetype.signature = _signature;
+    }
+    if (_archetype.chunks.empty() || _archetype.chunks.back().entities.size() >= _chunk_capacity) {
+        auto _chunk = chunk {};
+        for (const auto& _type : _signature) {
+            _chunk.columns.emplace(_type, _component_types.at(_type).create(_chunk_capacity));
+        }
+        _chunk.entities.reserve(_chunk_capacity);
+        _archetype.chunks.push_back(std::move(_chunk));
+    }
+    auto _location = location { &_archetype, _archetype.chunks.size() - 1, _archetype.chunks.back().entities.size() };
+    auto& _chunk = _archetype.chunks.back();
+    _chunk.entities.push_back(e);
+    if (_it != _locations.end()) {
+        auto _previous = _it->second;
+        const auto& _previous_chunk = _previous.arch->chunks[_previous.chunk];
+        for (const auto& _type : _previous.arch->signature) {
+            _component_types.at(_type).copy(_chunk.columns.at(_type).get(), _previous_chunk.columns.at(_type).get(), _previous.row, _location.row);
+        }
+        _remove_row(*_previous.arch, _previous.chunk, _previous.row);
+    }
+    _locations[e] = _location;
+    return _location;
+}
+
+void archetype_registry::_remove_row(archetype& arch, std::size_t chunk_idx, std::size_t row)
+{
+    // swap-and-pop with the last row of the archetype, so that every chunk
+    // but the last one always stays full
+    auto& _last_chunk = arch.chunks.back();
+    auto _last_row = _last_chunk.entities.size() - 1;
+    if (chunk_idx != arch.chunks.size() - 1 || row != _last_row) {
+        auto& _chunk = arch.chunks[chunk_idx];
+        auto _moved = _last_chunk.entities[_last_row];
+        for (const auto& _type : arch.signature) {
+            _component_types.at(_type).copy(_chunk.columns.at(_type).get(), _last_chunk.columns.at(_type).get(), _last_row, row);
+        }
+        _chunk.entities[row] = _moved;
+        _locations[_moved] = location { &arch, chunk_idx, row };
+    }
+    _last_chunk.entities.pop_back();
+    if (_last_chunk.entities.empty()) {
+        arch.chunks.pop_back();
+    }
+}
+
+const std::vector<archetype_registry::archetype*>& archetype_registry::_get_matching_archetypes(std::vector<std::type_index> types)
+{
+    std::sort(types.begin(), types.end());
+    auto& _query = _queries[types];
+    if (_query.version != _archetypes.size()) {
+        _query.archetypes.clear();
+        for (auto& _archetype : _archetypes) {
+            if (std::includes(_archetype.first.begin(), _archetype.first.end(), types.begin(), types.end())) {
+                _query.archetypes.push_back(&_archetype.second);
+            }
+        }
+        _query.version = _archetypes.size();
+    }
+    return _query.archetypes;
+}
+
+}
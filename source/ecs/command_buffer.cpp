@@ -0,0 +1,35 @@
+#include <compute/ecs/command_buffer.hpp>
+
+namespace compute {
+
+command_buffer::command_buffer(registry& reg)
+    : _registry(&reg)
+{
+}
+
+entity command_buffer::create_entity()
+{
+    return _registry->create_entity();
+}
+
+void command_buffer::destroy_entity(entity e)
+{
+    _destroyed.push_back(e);
+}
+
+std::size_t command_buffer::get_size() const
+{
+    auto _size = _destroyed.size();
+    for (const auto& _cmds : _commands) {
+        _size += _cmds.second.adds.size() + _cmds.second.sets.size() + _cmds.second.removes.size();
+    }
+    return _size;
+}
+
+void command_buffer::clear()
+{
+    _commands.clear();
+    _destroyed.clear();
+}
+
+}
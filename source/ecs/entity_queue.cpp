@@ -0,0 +1,27 @@
+#include <compute/ecs/entity_queue.hpp>
+
+#include <algorithm>
+
+namespace compute {
+
+destroy_queue::destroy_queue(const context& ctx, std::size_t capacity)
+    : _capacity(capacity)
+    , _count(ctx)
+    , _entities(ctx, std::max<std::size_t>(capacity, 1))
+{
+    _count.set(0u);
+}
+
+std::size_t destroy_queue::get_capacity() const
+{
+    return _capacity;
+}
+
+void destroy_queue::bind(kernel& krn, std::size_t& idx)
+{
+    krn.set_arg(idx++, _count);
+    krn.set_arg(idx++, static_cast<cl_uint>(_capacity));
+    krn.set_arg(idx++, _entities);
+}
+
+}
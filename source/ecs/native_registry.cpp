@@ -0,0 +1,129 @@
+#include <compute/ecs/native_registry.hpp>
+
+#include <algorithm>
+
+namespace compute {
+
+native_registry::native_registry(std::size_t threads_count, std::size_t capacity)
+    : _pool(std::make_unique<thread_pool>(threads_count))
+    , _capacity(std::max<std::size_t>(capacity, 1))
+    , _next_entity(0)
+{
+}
+
+entity native_registry::create_entity()
+{
+    if (!_free_entities.empty()) {
+        auto _idx = _free_entities.back();
+        _free_entities.pop_back();
+        _entity_alive[_idx] = true;
+        return make_entity(_idx, _entity_versions[_idx]);
+    }
+    _entity_versions.push_back(0);
+    _entity_alive.push_back(true);
+    return make_entity(_next_entity++, 0);
+}
+
+future<void> native_registry::destroy_entity(entity e)
+{
+    auto _idx = _get_alive_index(e);
+    for (auto& _store : _component_stores) {
+        if (_store.second.entity_slots.find(_idx) != _store.second.entity_slots.end()) {
+            _erase_component(_store.second, _idx);
+        }
+    }
+    _entity_alive[_idx] = false;
+    ++_entity_versions[_idx];
+    _free_entities.push_back(_idx);
+    return detail::make_ready_future();
+}
+
+bool native_registry::is_alive(entity e) const
+{
+    auto _idx = get_entity_index(e);
+    return _idx < _next_entity && _entity_alive[_idx] && _entity_versions[_idx] == get_entity_version(e);
+}
+
+std::size_t native_registry::get_threads_count() const
+{
+    return _pool->get_threads_count();
+}
+
+std::uint32_t native_registry::_get_alive_index(entity e) const
+{
+    if (!is_alive(e)) {
+        throw std::runtime_error("Entity is not alive");
+    }
+    return get_entity_index(e);
+}
+
+std::size_t native_registry::_insert_components(component_store& store, const std::vector<entity>& entities)
+{
+    auto _first_idx = store.slot_entities.size();
+    auto _indices = std::vector<std::uint32_t>(entities.size());
+    for (std::size_t _k = 0; _k < entities.size(); ++_k) {
+        _indices[_k] = _get_alive_index(entities[_k]);
+    }
+    for (std::size_t _k = 0; _k < entities.size(); ++_k) {
+        if (!store.entity_slots.emplace(_indices[_k], _first_idx + _k).second) {
+            for (std::size_t _j = 0; _j < _k; ++_j) {
+                store.entity_slots.erase(_indices[_j]);
+            }
+            throw std::runtime_error("Component already added to entity");
+        }
+    }
+    store.slot_entities.insert(store.slot_entities.end(), _indices.begin(), _indices.end());
+    return _first_idx;
+}
+
+void native_registry::_erase_component(component_store& store, std::uint32_t idx)
+{
+    auto _slot = store.entity_slots.at(idx);
+    auto _last_slot = store.slot_entities.size() - 1;
+    if (_slot != _last_slot) {
+        auto _moved_entity = store.slot_entities[_last_slot];
+        store.move(_slot, _last_slot);
+        store.slot_entities[_slot] = _moved_entity;
+        store.entity_slots[_moved_entity] = _slot;
+    }
+    store.pop();
+    store.slot_entities.pop_back();
+    store.entity_slots.erase(idx);
+}
+
+native_registry::component_join native_registry::_get_join(const std::vector<component_store*>& stores, bool entities) const
+{
+    auto _join = component_join {};
+    _join.aligned = std::all_of(stores.begin(), stores.end(), [&](const component_store* store) { return store->slot_entities == stores.front()->slot_entities; });
+    if (_join.aligned) {
+        _join.count = stores.front()->slot_entities.size();
+        if (entities) {
+            _join.entities.assign(stores.front()->slot_entities.begin(), stores.front()->slot_entities.end());
+        }
+        return _join;
+    }
+    // the smallest store drives the join, and every other store is probed for its entities
+    auto _driver = *std::min_element(stores.begin(), stores.end(), [](const component_store* a, const component_store* b) { return a->slot_entities.size() < b->slot_entities.size(); });
+    _join.slots.resize(stores.size());
+    auto _matched = std::vector<std::size_t>(stores.size());
+    for (const auto _entity : _driver->slot_entities) {
+        auto _found = true;
+        for (std::size_t _k = 0; _k < stores.size() && _found; ++_k) {
+            auto _it = stores[_k]->entity_slots.find(_entity);
+            _found = _it != stores[_k]->entity_slots.end();
+            _matched[_k] = _found ? _it->second : 0;
+        }
+        if (_found) {
+            for (std::size_t _k = 0; _k < stores.size(); ++_k) {
+                _join.slots[_k].push_back(_matched[_k]);
+            }
+            if (entities) {
+                _join.entities.push_back(_entity);
+            }
+        }
+    }
+    _join.count = _join.slots.front().size();
+    return _join;
+}
+
+}
@@ -1,17 +1,622 @@
+#include <compute/ecs/command_buffer.hpp>
 #include <compute/ecs/registry.hpp>
 
+#include <algorithm>
+
 namespace compute {
 
-registry::registry(const context& ctx, size_t capacity)
+namespace {
+
+    constexpr auto invalid_slot = static_cast<cl_uint>(0xffffffffu);
+
+    // up to this many runs of consecutive entities, direct writes to the slot table are
+    // cheaper than uploading an index table and launching a scatter kernel
+    constexpr std::size_t max_slot_table_runs = 2;
+
+    // kernels used by the registry itself, compiled once per registry on first use
+    const auto builtin_source = std::string(R"(
+#define CLECS_INVALID 0xffffffffu
+
+// slots[i] = slot of the i-th entity of the driving component in another component store
+kernel void clecs_join_probe(__global const uint* driver_entities, __global const uint* entity_slots, __global uint* probe, __global uint* mask)
+{
+    uint i = get_global_id(0);
+    uint s = entity_slots[driver_entities[i]];
+    probe[i] = s;
+    if (s == CLECS_INVALID) {
+        mask[i] = 0;
+    }
+}
+
+kernel void clecs_join_compact(__global const uint* mask, __global uint* positions, volatile __global uint* counter)
+{
+    uint i = get_global_id(0);
+    positions[i] = mask[i] ? atomic_inc(counter) : CLECS_INVALID;
+}
+
+// changed[positions[i]] = i for every slot marked in the mask
+kernel void clecs_changed_select(__global const uint* positions, __global uint* changed)
+{
+    uint i = get_global_id(0);
+    if (positions[i] != CLECS_INVALID) {
+        changed[positions[i]] = i;
+    }
+}
+
+kernel void clecs_join_select(__global const uint* probe, __global const uint* positions, __global uint* matches)
+{
+    uint i = get_global_id(0);
+    if (positions[i] != CLECS_INVALID) {
+        matches[positions[i]] = probe[i];
+    }
+}
+
+#ifdef CLECS_ELEMENT
+kernel void clecs_gather(__global const CLECS_ELEMENT* src, __global CLECS_ELEMENT* dst, __global const uint* slots)
+{
+    uint i = get_global_id(0);
+    uint k = i / CLECS_ELEMENT_COUNT;
+    uint w = i % CLECS_ELEMENT_COUNT;
+    dst[i] = src[slots[k] * CLECS_ELEMENT_COUNT + w];
+}
+
+kernel void clecs_scatter(__global const CLECS_ELEMENT* src, __global CLECS_ELEMENT* dst, __global const uint* slots)
+{
+    uint i = get_global_id(0);
+    uint k = i / CLECS_ELEMENT_COUNT;
+    uint w = i % CLECS_ELEMENT_COUNT;
+    dst[slots[k] * CLECS_ELEMENT_COUNT + w] = src[i];
+}
+
+// slots at or beyond the last tracked count have no previous value and always differ
+kernel void clecs_diff(__global const CLECS_ELEMENT* values, __global const CLECS_ELEMENT* shadow, __global uint* mask, uint tracked)
+{
+    uint k = get_global_id(0);
+    if (k >= tracked) {
+        mask[k] = 1;
+        return;
+    }
+    for (uint w = 0; w < CLECS_ELEMENT_COUNT; ++w) {
+        if (values[k * CLECS_ELEMENT_COUNT + w] != shadow[k * CLECS_ELEMENT_COUNT + w]) {
+            mask[k] = 1;
+            return;
+        }
+    }
+}
+#endif
+)");
+
+}
+
+std::size_t pipeline::get_size() const
+{
+    return _stages.size();
+}
+
+registry::registry(const context& ctx, size_t capacity, const std::string& options)
     : _context(ctx)
-    , _capacity(capacity)
+    , _capacity(std::max<std::size_t>(capacity, 1))
+    , _entity_capacity(_capacity)
     , _next_entity(0)
+    , _structure_version(0)
+    , _build_options(options)
 {
 }
 
 entity registry::create_entity()
 {
-    return entity { _next_entity++ };
+    if (!_free_entities.empty()) {
+        auto _idx = _free_entities.back();
+        _free_entities.pop_back();
+        _entity_alive[_idx] = true;
+        return make_entity(_idx, _entity_versions[_idx]);
+    }
+    if (_next_entity >= _entity_capacity) {
+        auto _grown_capacity = _entity_capacity * 2;
+        for (auto& _store : _component_stores) {
+            _store.second.slots->resize(_grown_capacity);
+            _store.second.slots->fill(invalid_slot, _entity_capacity, _grown_capacity - _entity_capacity);
+        }
+        _entity_capacity = _grown_capacity;
+    }
+    _entity_versions.push_back(0);
+    _entity_alive.push_back(true);
+    return make_entity(_next_entity++, 0);
+}
+
+future<void> registry::destroy_entity(entity e)
+{
+    auto _idx = _get_alive_index(e);
+    auto _result = detail::make_ready_future();
+    for (auto& _store : _component_stores) {
+        if (_store.second.entity_slots.find(_idx) != _store.second.entity_slots.end()) {
+            _result = _erase_component(_store.second, _idx);
+        }
+    }
+    _entity_alive[_idx] = false;
+    ++_entity_versions[_idx];
+    _free_entities.push_back(_idx);
+    return _result;
+}
+
+bool registry::is_alive(entity e) const
+{
+    auto _idx = get_entity_index(e);
+    return _idx < _next_entity && _entity_alive[_idx] && _entity_versions[_idx] == get_entity_version(e);
+}
+
+std::uint32_t registry::_get_alive_index(entity e) const
+{
+    if (!is_alive(e)) {
+        throw std::runtime_error("Entity is not alive");
+    }
+    return get_entity_index(e);
+}
+
+future<void> registry::step(std::size_t steps, const pipeline& pl)
+{
+    auto _queues_count = _context.get_queues_count();
+    auto _result = detail::make_ready_future();
+    if (_queues_count == 1) {
+        for (std::size_t _step = 0; _step < steps; ++_step) {
+            for (const auto& _stage : pl._stages) {
+                _result = _stage.dispatch(*this, 0, {});
+            }
+        }
+        return _result;
+    }
+
+    // systems run on the concurrent queues once everything already enqueued on the main
+    // queue has completed, ordered by read-after-write, write-after-read and write-after-write
+    // hazards on their component stores and on the packed buffers of their joins
+    auto _start = _context.barrier().get_event();
+    auto _stores = std::unordered_map<std::type_index, component_access> {};
+    auto _joins = std::map<std::vector<std::type_index>, component_access> {};
+    auto _queue_tails = std::vector<event>(_queues_count);
+    auto _next_queue = std::size_t { 0 };
+    for (std::size_t _step = 0; _step < steps; ++_step) {
+        for (const auto& _stage : pl._stages) {
+            auto _waits = std::vector<event> { _start };
+            auto _wait_write = [&](component_access& access) {
+                _waits.push_back(access.write);
+                _waits.insert(_waits.end(), access.reads.begin(), access.reads.end());
+            };
+            for (const auto& _type : _stage.reads) {
+                _waits.push_back(_stores[_type].write);
+            }
+            for (const auto& _type : _stage.writes) {
+                _wait_write(_stores[_type]);
+            }
+            _wait_write(_joins[_stage.join]);
+            auto _queue_idx = 1 + _next_queue++ % (_queues_count - 1);
+            _result = _stage.dispatch(*this, _queue_idx, _waits);
+            if (native_events({ _result.get_event() }).size() == 0) {
+                // systems with no matching entity enqueue nothing, so a barrier carries their
+                // wait list forward to the stages ordered after them
+                _result = _context.barrier(_waits, _queue_idx);
+            }
+            auto _done = _result.get_event();
+            for (const auto& _type : _stage.reads) {
+                // only the last read on each in-order queue needs to be waited for
+                auto& _reads = _stores[_type].reads;
+                _reads.resize(_queues_count);
+                _reads[_queue_idx] = _done;
+            }
+            for (const auto& _type : _stage.writes) {
+                _stores[_type] = component_access { _done, {} };
+            }
+            _joins[_stage.join] = component_access { _done, {} };
+            _queue_tails[_queue_idx] = _done;
+        }
+    }
+    // queues are in order, so their last commands cover everything dispatched on them
+    return _context.barrier(_queue_tails);
+}
+
+void registry::dump_trace(const std::filesystem::path& path) const
+{
+    _get_profiler()->dump_trace(path);
+}
+
+std::shared_ptr<profiler> registry::_get_profiler() const
+{
+    auto _profiler = _context.get_profiler();
+    if (!_profiler) {
+        throw std::runtime_error("Context was created without CL_QUEUE_PROFILING_ENABLE");
+    }
+    return _profiler;
+}
+
+registry::component_store& registry::_register_component_store(const std::type_index& type, const std::shared_ptr<void>& data)
+{
+    auto _store = component_store {};
+    _store.data = data;
+    _store.slots = std::make_shared<compute::array_buffer<cl_uint>>(_context, _entity_capacity);
+    _store.entities = std::make_shared<compute::array_buffer<cl_uint>>(_context, _capacity);
+    _store.slots->set_label(std::string(type.name()) + " slots");
+    _store.entities->set_label(std::string(type.name()) + " entities");
+    _store.slots->fill(invalid_slot);
+    return _component_stores.emplace(type, std::move(_store)).first->second;
+}
+
+std::size_t registry::_insert_components(component_store& store, const std::vector<entity>& entities)
+{
+    auto _first_idx = store.entity_slots.size();
+    auto _indices = std::vector<cl_uint>(entities.size());
+    for (std::size_t _k = 0; _k < entities.size(); ++_k) {
+        _indices[_k] = _get_alive_index(entities[_k]);
+    }
+    for (std::size_t _k = 0; _k < entities.size(); ++_k) {
+        if (!store.entity_slots.emplace(_indices[_k], _first_idx + _k).second) {
+            for (std::size_t _j = 0; _j < _k; ++_j) {
+                store.entity_slots.erase(_indices[_j]);
+            }
+            throw std::runtime_error("Component already added to entity");
+        }
+    }
+    if (entities.empty()) {
+        return _first_idx;
+    }
+    if (_first_idx + entities.size() > store.entities->get_size()) {
+        store.resize(_first_idx + entities.size());
+        store.entities->resize(_first_idx + entities.size());
+    }
+    store.slot_entities.insert(store.slot_entities.end(), _indices.begin(), _indices.end());
+    store.dirty = true;
+    store.entities->set(_first_idx, _indices);
+    ++_structure_version;
+    // entities are usually created and populated in order, so slot table updates are
+    // issued as one write per run of consecutive entities, or as a single scatter when
+    // the entities are scattered
+    auto _runs = std::size_t { 1 };
+    for (std::size_t _k = 1; _k < _indices.size(); ++_k) {
+        _runs += _indices[_k] != _indices[_k - 1] + 1 ? 1 : 0;
+    }
+    if (_runs > max_slot_table_runs) {
+        auto _slots = std::vector<cl_uint>(_indices.size());
+        for (std::size_t _k = 0; _k < _slots.size(); ++_k) {
+            _slots[_k] = static_cast<cl_uint>(_first_idx + _k);
+        }
+        _scatter_table(*store.slots, std::move(_indices), std::move(_slots));
+        return _first_idx;
+    }
+    auto _run_start = std::size_t { 0 };
+    for (std::size_t _k = 1; _k <= _indices.size(); ++_k) {
+        if (_k == _indices.size() || _indices[_k] != _indices[_k - 1] + 1) {
+            auto _run = std::vector<cl_uint>(_k - _run_start);
+            for (std::size_t _j = 0; _j < _run.size(); ++_j) {
+                _run[_j] = static_cast<cl_uint>(_first_idx + _run_start + _j);
+            }
+            store.slots->set(_indices[_run_start], std::move(_run));
+            _run_start = _k;
+        }
+    }
+    return _first_idx;
+}
+
+future<void> registry::_erase_component(component_store& store, std::uint32_t idx)
+{
+    auto _slot = store.entity_slots.at(idx);
+    auto _last_slot = store.slot_entities.size() - 1;
+    if (_slot != _last_slot) {
+        auto _moved = store.slot_entities[_last_slot];
+        store.move(_last_slot, _slot);
+        store.entities->copy(*store.entities, _last_slot, _slot, 1);
+        store.slots->set(_moved, static_cast<cl_uint>(_slot));
+        store.slot_entities[_slot] = _moved;
+        store.entity_slots[_moved] = _slot;
+    }
+    store.slot_entities.pop_back();
+    store.entity_slots.erase(idx);
+    // slots past the new size hold no shadow anymore, so components added there are reported
+    store.shadow_count = std::min(store.shadow_count, store.slot_entities.size());
+    store.dirty = true;
+    ++_structure_version;
+    return store.slots->set(idx, invalid_slot);
+}
+
+future<void> registry::_erase_components(component_store& store, const std::vector<std::uint32_t>& indices)
+{
+    // swap-and-pop every removal on the host, tracking where each displaced component
+    // originally was; displaced components always come from slots past the final size
+    // and land in slots below it, so all of them are moved at once on the device
+    auto _origins = std::unordered_map<std::size_t, std::size_t> {};
+    auto _touched = std::vector<cl_uint> {};
+    for (auto _idx : indices) {
+        auto _slot = store.entity_slots.at(_idx);
+        auto _last_slot = store.slot_entities.size() - 1;
+        if (_slot != _last_slot) {
+            auto _moved = store.slot_entities[_last_slot];
+            auto _origin = _origins.find(_last_slot);
+            _origins[_slot] = _origin == _origins.end() ? _last_slot : _origin->second;
+            store.slot_entities[_slot] = _moved;
+            store.entity_slots[_moved] = _slot;
+            _touched.push_back(_moved);
+        }
+        _origins.erase(_last_slot);
+        store.slot_entities.pop_back();
+        store.entity_slots.erase(_idx);
+        _touched.push_back(_idx);
+    }
+    ++_structure_version;
+    store.shadow_count = std::min(store.shadow_count, store.slot_entities.size());
+    store.dirty = true;
+    auto _result = detail::make_ready_future();
+    if (!_origins.empty()) {
+        auto _sources = std::vector<cl_uint> {};
+        auto _destinations = std::vector<cl_uint> {};
+        auto _entities = std::vector<cl_uint> {};
+        for (const auto& _origin : _origins) {
+            _sources.push_back(static_cast<cl_uint>(_origin.second));
+            _destinations.push_back(static_cast<cl_uint>(_origin.first));
+            _entities.push_back(store.slot_entities[_origin.first]);
+        }
+        auto _count = _origins.size();
+        if (store.read_only) {
+            // kernels cannot write read-only buffers, so components are moved with device copies
+            for (std::size_t _k = 0; _k < _count; ++_k) {
+                store.move(_sources[_k], _destinations[_k]);
+            }
+        }
+        _reserve_scratch(_command_destinations, _count);
+        _command_destinations->set(0, std::move(_destinations));
+        if (!store.read_only) {
+            _reserve_scratch(_command_sources, _count);
+            _command_sources->set(0, std::move(_sources));
+            store.move_slots(*this, store, _count);
+        }
+        _reserve_scratch(_command_values, _count);
+        _command_values->set(0, std::move(_entities));
+        _result = _run_scatter_table(*store.entities, *_command_destinations, *_command_values, _count);
+    }
+    std::sort(_touched.begin(), _touched.end());
+    _touched.erase(std::unique(_touched.begin(), _touched.end()), _touched.end());
+    auto _slots = std::vector<cl_uint>(_touched.size());
+    for (std::size_t _k = 0; _k < _touched.size(); ++_k) {
+        auto _slot = store.entity_slots.find(_touched[_k]);
+        _slots[_k] = _slot == store.entity_slots.end() ? invalid_slot : static_cast<cl_uint>(_slot->second);
+    }
+    return _scatter_table(*store.slots, std::move(_touched), std::move(_slots));
+}
+
+future<void> registry::_scatter_table(compute::array_buffer<cl_uint>& table, std::vector<cl_uint>&& indices, std::vector<cl_uint>&& values)
+{
+    auto _count = indices.size();
+    if (_count == 0) {
+        return detail::make_ready_future();
+    }
+    _reserve_scratch(_command_indices, _count);
+    _reserve_scratch(_command_values, _count);
+    _command_indices->set(0, std::move(indices));
+    _command_values->set(0, std::move(values));
+    return _run_scatter_table(table, *_command_indices, *_command_values, _count);
+}
+
+future<void> registry::_run_scatter_table(compute::array_buffer<cl_uint>& table, compute::array_buffer<cl_uint>& indices, compute::array_buffer<cl_uint>& values, std::size_t count)
+{
+    // table[indices[k]] = values[k]
+    auto _krn = _get_or_create_builtin_kernel("clecs_scatter", _get_copy_options<cl_uint>());
+    _krn->set_label("clecs_scatter table");
+    _krn->set_arg(0, values);
+    _krn->set_arg(1, table);
+    _krn->set_arg(2, indices);
+    return _krn->run({ count });
 }
 
-}
\ No newline at end of file
+future<void> registry::_run_gather_table(compute::array_buffer<cl_uint>& table, compute::array_buffer<cl_uint>& indices, compute::array_buffer<cl_uint>& values, std::size_t count, std::size_t queue_idx, const std::vector<event>& wait_list)
+{
+    // values[k] = table[indices[k]]
+    auto _krn = _get_or_create_builtin_kernel("clecs_gather", _get_copy_options<cl_uint>());
+    _krn->set_label("clecs_gather table");
+    _krn->set_arg(0, table);
+    _krn->set_arg(1, values);
+    _krn->set_arg(2, indices);
+    return _krn->run({ count }, wait_list, queue_idx);
+}
+
+future<void> registry::reconcile(destroy_queue& queue)
+{
+    auto _count = std::min(static_cast<std::size_t>(queue._count.fetch().get()), queue._capacity);
+    auto _result = queue._count.set(0u);
+    if (_count == 0) {
+        return _result;
+    }
+    auto _indices = std::vector<cl_uint>(_count);
+    queue._entities.fetch(_indices.data(), 0, _count).get();
+    auto _commands = command_buffer(*this);
+    for (auto _idx : _indices) {
+        if (_idx < _next_entity && _entity_alive[_idx]) {
+            _commands.destroy_entity(make_entity(_idx, _entity_versions[_idx]));
+        }
+    }
+    return apply(_commands);
+}
+
+future<void> registry::apply(command_buffer& cmd)
+{
+    if (cmd._registry != this) {
+        throw std::invalid_argument("Command buffer records changes for another registry");
+    }
+    auto _destroyed = std::vector<std::uint32_t> {};
+    for (auto _entity : cmd._destroyed) {
+        _destroyed.push_back(_get_alive_index(_entity));
+    }
+    std::sort(_destroyed.begin(), _destroyed.end());
+    _destroyed.erase(std::unique(_destroyed.begin(), _destroyed.end()), _destroyed.end());
+    auto _removals = std::unordered_map<std::type_index, std::vector<std::uint32_t>> {};
+    for (auto& _cmds : cmd._commands) {
+        for (const auto* _entities : { &_cmds.second.adds, &_cmds.second.sets }) {
+            for (auto _entity : *_entities) {
+                if (std::binary_search(_destroyed.begin(), _destroyed.end(), _get_alive_index(_entity))) {
+                    throw std::runtime_error("Component recorded for a destroyed entity");
+                }
+            }
+        }
+        auto _it = _component_stores.find(_cmds.first);
+        auto _removed = std::unordered_set<std::uint32_t> {};
+        for (auto _entity : _cmds.second.removes) {
+            auto _idx = _get_alive_index(_entity);
+            if (_it == _component_stores.end() || _it->second.entity_slots.find(_idx) == _it->second.entity_slots.end()) {
+                throw std::runtime_error("Component not found for entity");
+            }
+            _removals[_cmds.first].push_back(_idx);
+            _removed.insert(_idx);
+        }
+        // adds and sets are applied after removals, and sets after adds
+        auto _has_component = [&](std::uint32_t idx) {
+            return _it != _component_stores.end() && _it->second.entity_slots.find(idx) != _it->second.entity_slots.end() && _removed.find(idx) == _removed.end();
+        };
+        auto _added = std::unordered_set<std::uint32_t> {};
+        for (auto _entity : _cmds.second.adds) {
+            auto _idx = get_entity_index(_entity);
+            if (_has_component(_idx) || !_added.insert(_idx).second) {
+                throw std::runtime_error("Component already added to entity");
+            }
+        }
+        for (auto _entity : _cmds.second.sets) {
+            auto _idx = get_entity_index(_entity);
+            if (!_has_component(_idx) && _added.find(_idx) == _added.end()) {
+                throw std::runtime_error("Component not found for entity");
+            }
+        }
+    }
+    for (auto& _store : _component_stores) {
+        for (auto _idx : _destroyed) {
+            if (_store.second.entity_slots.find(_idx) != _store.second.entity_slots.end()) {
+                _removals[_store.first].push_back(_idx);
+            }
+        }
+    }
+
+    auto _result = detail::make_ready_future();
+    for (auto& _removal : _removals) {
+        auto& _indices = _removal.second;
+        std::sort(_indices.begin(), _indices.end());
+        _indices.erase(std::unique(_indices.begin(), _indices.end()), _indices.end());
+        _result = _erase_components(_component_stores.at(_removal.first), _indices);
+    }
+    for (auto& _cmds : cmd._commands) {
+        if (!_cmds.second.adds.empty() || !_cmds.second.sets.empty()) {
+            _result = _cmds.second.apply(*this, _cmds.second);
+        }
+    }
+    for (auto _idx : _destroyed) {
+        _entity_alive[_idx] = false;
+        ++_entity_versions[_idx];
+        _free_entities.push_back(_idx);
+    }
+    cmd.clear();
+    return _result;
+}
+
+registry::component_join& registry::_get_or_update_join(const std::vector<std::type_index>& types)
+{
+    auto& _join = _component_joins[types];
+    if (_join.version == _structure_version && !_join.matches.empty()) {
+        return _join;
+    }
+    auto _stores = std::vector<component_store*> {};
+    for (const auto& _type : types) {
+        _stores.push_back(&_component_stores.at(_type));
+    }
+    auto _driver = static_cast<std::size_t>(std::min_element(_stores.begin(), _stores.end(), [](const component_store* a, const component_store* b) {
+        return a->entity_slots.size() < b->entity_slots.size();
+    }) - _stores.begin());
+    auto _count = _stores[_driver]->entity_slots.size();
+    _join.version = _structure_version;
+    _join.matches.resize(types.size());
+    for (auto& _matches : _join.matches) {
+        _reserve_scratch(_matches, _count);
+    }
+
+    // components stored at the same slots for the same entities need no join at all
+    _join.aligned = std::all_of(_stores.begin(), _stores.end(), [&](const component_store* store) {
+        return store->entity_slots.size() == _count;
+    });
+    for (std::size_t _j = 0; _join.aligned && _j < _stores.size(); ++_j) {
+        if (_j == _driver) {
+            continue;
+        }
+        for (const auto& _entity_slot : _stores[_driver]->entity_slots) {
+            auto _it = _stores[_j]->entity_slots.find(_entity_slot.first);
+            if (_it == _stores[_j]->entity_slots.end() || _it->second != _entity_slot.second) {
+                _join.aligned = false;
+                break;
+            }
+        }
+    }
+    if (_join.aligned || _count == 0) {
+        _join.count = _count;
+        return _join;
+    }
+
+    // probe every store with the entities of the smallest one, then compact the
+    // entities present in all of them into per-store match lists
+    _reserve_scratch(_join_mask, _count);
+    _reserve_scratch(_join_positions, _count);
+    _join_probes.resize(std::max(_join_probes.size(), types.size()));
+    for (auto& _probe : _join_probes) {
+        _reserve_scratch(_probe, _count);
+    }
+    if (!_join_counter) {
+        _join_counter = std::make_shared<compute::buffer<cl_uint>>(_context);
+    }
+    _join_mask->fill(1u, 0, _count);
+    _join_counter->set(0u);
+    auto _probe = _get_or_create_builtin_kernel("clecs_join_probe");
+    for (std::size_t _j = 0; _j < _stores.size(); ++_j) {
+        _probe->set_arg(0, *_stores[_driver]->entities);
+        _probe->set_arg(1, *_stores[_j]->slots);
+        _probe->set_arg(2, *_join_probes[_j]);
+        _probe->set_arg(3, *_join_mask);
+        _probe->run({ _count });
+    }
+    auto _compact = _get_or_create_builtin_kernel("clecs_join_compact");
+    _compact->set_arg(0, *_join_mask);
+    _compact->set_arg(1, *_join_positions);
+    _compact->set_arg(2, *_join_counter);
+    _compact->run({ _count });
+    auto _select = _get_or_create_builtin_kernel("clecs_join_select");
+    for (std::size_t _j = 0; _j < _stores.size(); ++_j) {
+        _select->set_arg(0, *_join_probes[_j]);
+        _select->set_arg(1, *_join_positions);
+        _select->set_arg(2, *_join.matches[_j]);
+        _select->run({ _count });
+    }
+    _join.count = static_cast<std::size_t>(_join_counter->fetch().get());
+    return _join;
+}
+
+std::size_t registry::_compact_changes(std::size_t count)
+{
+    _reserve_scratch(_join_positions, count);
+    _reserve_scratch(_changed_slots, count);
+    if (!_join_counter) {
+        _join_counter = std::make_shared<compute::buffer<cl_uint>>(_context);
+    }
+    _join_counter->set(0u);
+    auto _compact = _get_or_create_builtin_kernel("clecs_join_compact");
+    _compact->set_arg(0, *_join_mask);
+    _compact->set_arg(1, *_join_positions);
+    _compact->set_arg(2, *_join_counter);
+    _compact->run({ count });
+    auto _select = _get_or_create_builtin_kernel("clecs_changed_select");
+    _select->set_arg(0, *_join_positions);
+    _select->set_arg(1, *_changed_slots);
+    _select->run({ count });
+    return static_cast<std::size_t>(_join_counter->fetch().get());
+}
+
+std::shared_ptr<compute::kernel> registry::_get_or_create_builtin_kernel(const std::string& name, const std::string& options)
+{
+    auto _key = name + " " + options;
+    auto _it = _builtin_kernels.find(_key);
+    if (_it != _builtin_kernels.end()) {
+        return _it->second;
+    }
+    auto _krn = std::make_shared<compute::kernel>(_context, builtin_source, name, options);
+    _builtin_kernels.emplace(_key, _krn);
+    return _krn;
+}
+
+}
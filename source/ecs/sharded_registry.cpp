@@ -0,0 +1,114 @@
+#include <compute/ecs/sharded_registry.hpp>
+
+#include <algorithm>
+
+namespace compute {
+
+sharded_registry::sharded_registry(const std::vector<std::reference_wrapper<const context>>& contexts, std::size_t capacity, const std::string& options)
+    : _next_entity(0)
+{
+    if (contexts.empty()) {
+        throw std::invalid_argument("Sharded registry requires at least one context");
+    }
+    for (const auto& _context : contexts) {
+        _shards.push_back(std::make_unique<registry>(_context.get(), capacity, options));
+    }
+    _shard_sizes.resize(_shards.size(), 0);
+    _shard_entities.resize(_shards.size());
+}
+
+entity sharded_registry::create_entity()
+{
+    auto _shard = static_cast<std::size_t>(std::min_element(_shard_sizes.begin(), _shard_sizes.end()) - _shard_sizes.begin());
+    auto _local = _shards[_shard]->create_entity();
+    auto _local_idx = get_entity_index(_local);
+    if (_local_idx >= _shard_entities[_shard].size()) {
+        _shard_entities[_shard].resize(_local_idx + 1);
+    }
+    ++_shard_sizes[_shard];
+    auto _idx = std::uint32_t { 0 };
+    if (!_free_entities.empty()) {
+        _idx = _free_entities.back();
+        _free_entities.pop_back();
+        _entity_alive[_idx] = true;
+        _entities[_idx] = sharded_entity { _shard, _local };
+    } else {
+        _idx = _next_entity++;
+        _entity_versions.push_back(0);
+        _entity_alive.push_back(true);
+        _entities.push_back(sharded_entity { _shard, _local });
+    }
+    auto _entity = make_entity(_idx, _entity_versions[_idx]);
+    _shard_entities[_shard][_local_idx] = _entity;
+    return _entity;
+}
+
+future<void> sharded_registry::destroy_entity(entity e)
+{
+    auto _entity = _get_alive_entity(e);
+    auto _idx = get_entity_index(e);
+    auto _result = _shards[_entity.shard]->destroy_entity(_entity.local);
+    --_shard_sizes[_entity.shard];
+    _entity_alive[_idx] = false;
+    ++_entity_versions[_idx];
+    _free_entities.push_back(_idx);
+    return _result;
+}
+
+bool sharded_registry::is_alive(entity e) const
+{
+    auto _idx = get_entity_index(e);
+    return _idx < _next_entity && _entity_alive[_idx] && _entity_versions[_idx] == get_entity_version(e);
+}
+
+future<void> sharded_registry::step(std::size_t steps, const pipeline& pl)
+{
+    if (!pl._uniforms_only) {
+        throw std::invalid_argument("Sharded pipelines only accept uniform values");
+    }
+    auto _futures = std::vector<future<void>> {};
+    for (auto& _shard : _shards) {
+        _futures.push_back(_shard->step(steps, pl));
+    }
+    return _join_futures(std::move(_futures));
+}
+
+std::size_t sharded_registry::get_shards_count() const
+{
+    return _shards.size();
+}
+
+std::size_t sharded_registry::get_shard_index(entity e) const
+{
+    return _get_alive_entity(e).shard;
+}
+
+registry& sharded_registry::get_shard(std::size_t idx)
+{
+    if (idx >= _shards.size()) {
+        throw std::out_of_range("Shard index out of range");
+    }
+    return *_shards[idx];
+}
+
+const sharded_registry::sharded_entity& sharded_registry::_get_alive_entity(entity e) const
+{
+    if (!is_alive(e)) {
+        throw std::runtime_error("Entity is not alive");
+    }
+    return _entities[get_entity_index(e)];
+}
+
+future<void> sharded_registry::_join_futures(std::vector<future<void>>&& futures)
+{
+    // events of different contexts cannot be waited on together, so shards are joined on the host
+    auto _futures = std::make_shared<std::vector<future<void>>>(std::move(futures));
+    auto _joined = std::async(std::launch::deferred, [_futures]() {
+        for (auto& _future : *_futures) {
+            _future.get();
+        }
+    });
+    return future<void>(std::move(_joined), event {});
+}
+
+}